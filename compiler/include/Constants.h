@@ -54,12 +54,29 @@ const int soundsArray[paramLen] = {880, 1760, 2640, 3520, 0, 0, 0, 0}; // tone v
 const int defaultBeat[paramLen] = {200, 200, 400, 400, 200, 200, 0, 0};
 
 // lexer
-const uint8_t keywordCount = 8;
+const uint8_t keywordCount = 13;
+const uint16_t estimatedSymbols = 64;  // initial capacity of the symbol index, must be a power of two
 
 // parser
 const uint8_t estimatedProgramStatements = 128;
 const uint8_t estimatedBlockStatements = 16;
 const uint8_t estimatedArrayElements = 8;
+const uint8_t maxObjectProperties = 32;
+const uint8_t estimatedConstants = 16;
+const uint16_t maxConstants = 256;  // distinct string literals of a program
+
+// scheduler
+const unsigned long yieldBudgetMicros = 1000;  // time the interpreter or a wait may run before the SDK gets to run its tasks
+const uint8_t yieldCheckSteps = 32;           // evaluation steps between two reads of the clock
 
 // interpreter
-const uint8_t estimatedFunctionArgs = 8;
\ No newline at end of file
+const uint8_t estimatedFunctionArgs = 8;
+const uint8_t maxFunctionArgs = 8;
+const size_t gameRegionBytes = 16384;  // memory reserved for the runtime values of a game
+const uint8_t regionSizeClasses = 16;
+const uint8_t maxScopeDepth = 16;       // nested scopes of blocks that declare variables and of function calls
+const uint8_t maxNestingDepth = 32;     // nested programs, blocks and loops, executed without recursion
+const uint8_t maxExpressionDepth = 32;  // nested subexpressions, evaluated recursively on the continuation stack
+const uint8_t maxCallDepth = 8;         // nested calls of user-defined functions, each one recurses on the continuation stack
+const uint8_t envInlineVariables = 4;  // variables of a scope stored without allocating a table, must be a power of two
+const uint8_t maxBuiltinNameLength = 31;  // names of builtins are stored inline in the flash resident table
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "ErrorHandler.h"
+
+/**
+ * @class Fixed
+ * @brief Q16.16 fixed-point arithmetic, fractional numbers without floating point.
+ *
+ * A fixed-point number is stored as a plain `int32_t` scaled by 2^16, so addition, subtraction, modulo
+ * and comparisons are the integer instructions, multiplication and division only need a 64 bit intermediate.
+ * The representable range is -32768 to 32767.99998, conversions and arithmetic leaving it restart with an error
+ * instead of wrapping around.
+ */
+class Fixed {
+public:
+  static const uint8_t fractionBits = 16;         /**< The number of bits after the binary point */
+  static const int32_t one = 1 << fractionBits;   /**< The fixed-point representation of 1 */
+
+  /**
+   * @brief Checks whether an integer can be converted to fixed-point.
+   */
+  static bool fitsInt(int value) {
+    return value >= INT16_MIN && value <= INT16_MAX;
+  }
+
+  /**
+   * @brief Checks whether the wide result of an operation is representable in fixed-point.
+   */
+  static bool fits(int64_t result) {
+    return result >= INT32_MIN && result <= INT32_MAX;
+  }
+
+  /**
+   * @brief Converts an integer to a wide fixed-point number, which holds every integer exactly.
+   */
+  static int64_t widen(int value) {
+    return (int64_t)value * one;
+  }
+
+  /**
+   * @brief Narrows the wide result of an operation to fixed-point.
+   * @throws ErrorHandler::restart if the result is outside of the representable range.
+   */
+  static int32_t checked(int64_t result) {
+    if (!fits(result)) {
+      ErrorHandler::restart("Decimal number overflow, the result is outside of -32768 to 32767");
+    }
+    return (int32_t)result;
+  }
+
+  /**
+   * @brief Converts an integer to fixed-point.
+   * @throws ErrorHandler::restart if the integer is outside of the representable range.
+   */
+  static int32_t fromInt(int value) {
+    if (!fitsInt(value)) {
+      ErrorHandler::restart("Number is too large to be used as a decimal number");
+    }
+    return (int32_t)((uint32_t)value << fractionBits);
+  }
+
+  /**
+   * @brief Converts a fixed-point number to an integer, truncating towards zero.
+   */
+  static int toInt(int32_t fixed) {
+    return fixed / one;
+  }
+
+  /**
+   * @brief Adds two fixed-point numbers.
+   * @throws ErrorHandler::restart if the sum is outside of the representable range.
+   */
+  static int32_t add(int32_t a, int32_t b) {
+    return checked((int64_t)a + b);
+  }
+
+  /**
+   * @brief Subtracts two fixed-point numbers.
+   * @throws ErrorHandler::restart if the difference is outside of the representable range.
+   */
+  static int32_t sub(int32_t a, int32_t b) {
+    return checked((int64_t)a - b);
+  }
+
+  /**
+   * @brief Multiplies two fixed-point numbers.
+   * @throws ErrorHandler::restart if the product is outside of the representable range.
+   */
+  static int32_t mul(int32_t a, int32_t b) {
+    return checked(((int64_t)a * b) >> fractionBits);
+  }
+
+  /**
+   * @brief Divides two fixed-point numbers, `b` must not be 0.
+   * @throws ErrorHandler::restart if the quotient is outside of the representable range.
+   */
+  static int32_t div(int32_t a, int32_t b) {
+    return checked(((int64_t)a * one) / b);
+  }
+
+  /**
+   * @brief Parses a decimal number like "-1.25" to fixed-point, rounding to the nearest representable value.
+   * @param str The decimal number, digits with an optional leading '-' and at most one '.'.
+   * @return The fixed-point number.
+   * @throws ErrorHandler::restart if the number is outside of the representable range.
+   */
+  static int32_t parse(const char* str) {
+    bool negative = *str == '-';
+    if (negative) {
+      str++;
+    }
+
+    uint32_t intPart = 0;
+    while (isDigit(*str)) {
+      intPart = intPart * 10 + (*str - '0');
+      if (intPart > INT16_MAX + 1) {
+        ErrorHandler::restart("Decimal number is out of range");
+      }
+      str++;
+    }
+
+    // digits beyond the precision of the fraction are ignored
+    uint32_t fraction = 0;
+    uint32_t scale = 1;
+    if (*str == '.') {
+      str++;
+      while (isDigit(*str)) {
+        if (scale < 100000) {
+          fraction = fraction * 10 + (*str - '0');
+          scale *= 10;
+        }
+        str++;
+      }
+    }
+
+    int64_t magnitude = ((int64_t)intPart << fractionBits) + (int64_t)((((uint64_t)fraction << fractionBits) + scale / 2) / scale);
+    return checked(negative ? -magnitude : magnitude);
+  }
+
+  /**
+   * @brief Formats a fixed-point number with up to four decimals, e.g. "1.5" or "-3.0".
+   * @param fixed The fixed-point number.
+   * @param buf The buffer to write to.
+   * @param len The size of the buffer, 13 bytes fit every number.
+   */
+  static void toString(int32_t fixed, char* buf, size_t len) {
+    uint32_t magnitude = fixed < 0 ? -(uint32_t)fixed : (uint32_t)fixed;
+    uint32_t tenThousandths = (uint32_t)(((uint64_t)magnitude * 10000 + one / 2) >> fractionBits);
+    uint32_t decimals = tenThousandths % 10000;
+    uint8_t digits = 4;
+    while (digits > 1 && decimals % 10 == 0) {
+      decimals /= 10;
+      digits--;
+    }
+
+    snprintf(buf, len, "%s%u.%0*u", fixed < 0 ? "-" : "", (unsigned int)(tenThousandths / 10000), digits, (unsigned int)decimals);
+  }
+};
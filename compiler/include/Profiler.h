@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Constants.h"
+
+/**
+ * @class Profiler
+ * @brief Counts how often the fast paths of the interpreter are taken, to check that they pay off on real games.
+ */
+class Profiler {
+public:
+  /**
+   * @brief The counted events.
+   */
+  enum class Counter : uint8_t {
+    IdentifierCacheHit,   /**< An identifier was resolved from its inline cache */
+    IdentifierCacheMiss,  /**< An identifier had to be resolved by walking the scopes */
+    SchedulerYield,       /**< The scheduler handed control to the SDK */
+    NestingDepth,         /**< The deepest nesting of statements, a peak instead of a count */
+    CallDepth,            /**< The deepest nesting of function calls, a peak instead of a count */
+    Deoptimization,       /**< A specialized node saw other types and fell back to its generic version */
+    Count                 /**< The number of counters, not a counter itself */
+  };
+
+  /**
+   * @brief Counts one occurrence of an event.
+   */
+  static void count(Counter counter) {
+    counters[(uint8_t)counter]++;
+  }
+
+  /**
+   * @brief Raises a peak counter to the given value, if it is higher.
+   */
+  static void peak(Counter counter, uint32_t value) {
+    if (value > counters[(uint8_t)counter]) {
+      counters[(uint8_t)counter] = value;
+    }
+  }
+
+  /**
+   * @brief Returns how often an event occurred since the last reset.
+   */
+  static uint32_t get(Counter counter) {
+    return counters[(uint8_t)counter];
+  }
+
+  /**
+   * @brief Resets all counters to zero.
+   */
+  static void reset() {
+    for (uint32_t& counter : counters) {
+      counter = 0;
+    }
+  }
+
+  /**
+   * @brief Prints all counters for debugging purposes.
+   * @param location A string indicating where the counters are being logged.
+   */
+  static void printStats(const char* location) {
+    Serial.print("\n-----");
+    Serial.print(location);
+    Serial.println("-----");
+    Serial.print("Identifier cache hits: ");
+    Serial.println(get(Counter::IdentifierCacheHit));
+    Serial.print("Identifier cache misses: ");
+    Serial.println(get(Counter::IdentifierCacheMiss));
+    Serial.print("Scheduler yields: ");
+    Serial.println(get(Counter::SchedulerYield));
+    Serial.print("Deepest nesting: ");
+    Serial.print(get(Counter::NestingDepth));
+    Serial.print(" of ");
+    Serial.println(maxNestingDepth);
+    Serial.print("Deepest calls: ");
+    Serial.print(get(Counter::CallDepth));
+    Serial.print(" of ");
+    Serial.println(maxCallDepth);
+    Serial.print("Deoptimized nodes: ");
+    Serial.println(get(Counter::Deoptimization));
+  }
+
+private:
+  static inline uint32_t counters[(uint8_t)Counter::Count] = {}; /**< The occurrences of each event */
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Constants.h"
+#include "Profiler.h"
+
+/**
+ * @class Scheduler
+ * @brief Cooperative scheduling, hands control to the SDK (WiFi, ESP-NOW) once per time budget.
+ *
+ * Calling `yield()` is a context switch, too expensive to do for every evaluated node.
+ * Instead the interpreter counts steps, only every `yieldCheckSteps` steps the clock is read and
+ * `yield()` is only called once `yieldBudgetMicros` passed since the last time.
+ */
+class Scheduler {
+public:
+  /**
+   * @brief Counts one evaluation step, cheap enough to be called for every evaluated node.
+   */
+  static void step() {
+    if (++steps >= yieldCheckSteps) {
+      steps = 0;
+      poll();
+    }
+  }
+
+  /**
+   * @brief Yields if the budget is spent, to be called in every iteration of a busy wait.
+   */
+  static void poll() {
+    if (micros() - lastYield >= yieldBudgetMicros) {
+      yieldNow();
+    }
+  }
+
+  /**
+   * @brief Yields immediately and starts a new budget.
+   */
+  static void yieldNow() {
+    yield();
+    Profiler::count(Profiler::Counter::SchedulerYield);
+    lastYield = micros();
+    steps = 0;
+  }
+
+private:
+  static inline unsigned long lastYield = 0; /**< The time of the last yield in microseconds */
+  static inline uint8_t steps = 0;           /**< The steps counted since the clock was last read */
+};
@@ -212,7 +212,7 @@ bool PadsComm::waitWithCancelCheck(unsigned long ms) {
 }
 
 bool PadsComm::checkForCancelSignal() {
-  yield(); // do WiFi tasks
+  Scheduler::poll(); // do WiFi tasks once the budget is spent
 
   if (btComm->hasUnreadBytes()) {
     uint8_t incomingByte = btComm->readByte();
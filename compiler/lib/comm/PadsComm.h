@@ -9,6 +9,7 @@
 #include "BLEComm.h"
 #include "ErrorHandler.h"
 #include "Constants.h"
+#include "Scheduler.h"
 /**
  * @class PadsComm
  * @brief Manages communication between the central module and smart sport pads using ESP-NOW.
@@ -0,0 +1,95 @@
+#include "Bindings.h"
+
+Bindings::~Bindings() {
+  if (table != nullptr) {
+    for (uint16_t i = 0; i < capacity; i++) {
+      table[i].~Binding();
+    }
+    Region::deallocate(table, capacity * sizeof(Binding));
+  }
+}
+
+Bindings::Binding* Bindings::find(uint16_t symbol) {
+  if (table == nullptr) {
+    for (uint16_t i = 0; i < count; i++) {
+      if (inlineBindings[i].symbol() == symbol) {
+        return &inlineBindings[i];
+      }
+    }
+    return nullptr;
+  }
+
+  uint16_t mask = capacity - 1;
+  for (uint16_t i = symbol & mask;; i = (i + 1) & mask) {
+    if (table[i].key == emptyKey) {
+      return nullptr;
+    }
+    if (table[i].symbol() == symbol) {
+      return &table[i];
+    }
+  }
+}
+
+Bindings::Binding* Bindings::insert(uint16_t symbol, bool constant) {
+  if (find(symbol) != nullptr) {
+    return nullptr;
+  }
+
+  uint16_t key = constant ? symbol | constFlag : symbol;
+
+  if (table == nullptr && count < envInlineVariables) {
+    inlineBindings[count].key = key;
+    return &inlineBindings[count++];
+  }
+
+  // keep the load factor at most 3/4
+  if ((count + 1) * 4 > capacity * 3) {
+    grow();
+  }
+
+  uint16_t mask = capacity - 1;
+  uint16_t i = symbol & mask;
+  while (table[i].key != emptyKey) {
+    i = (i + 1) & mask;
+  }
+
+  table[i].key = key;
+  count++;
+  return &table[i];
+}
+
+void Bindings::grow() {
+  uint16_t newCapacity = capacity == 0 ? envInlineVariables * 2 : capacity * 2;
+  Binding* newTable = static_cast<Binding*>(Region::allocate(newCapacity * sizeof(Binding)));
+  for (uint16_t i = 0; i < newCapacity; i++) {
+    new (&newTable[i]) Binding();
+  }
+
+  // symbol ids are dense and small, so they are used as their own hash
+  uint16_t mask = newCapacity - 1;
+  auto rehash = [&](Binding& binding) {
+    uint16_t i = binding.symbol() & mask;
+    while (newTable[i].key != emptyKey) {
+      i = (i + 1) & mask;
+    }
+    newTable[i].key = binding.key;
+    newTable[i].value = std::move(binding.value);
+  };
+
+  if (table == nullptr) {
+    for (uint16_t i = 0; i < count; i++) {
+      rehash(inlineBindings[i]);
+    }
+  } else {
+    for (uint16_t i = 0; i < capacity; i++) {
+      if (table[i].key != emptyKey) {
+        rehash(table[i]);
+      }
+      table[i].~Binding();
+    }
+    Region::deallocate(table, capacity * sizeof(Binding));
+  }
+
+  table = newTable;
+  capacity = newCapacity;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Constants.h"
+#include "Region.h"
+#include "Values.h"
+
+/**
+ * @class Bindings
+ * @brief The variables of one scope, an open addressing hash table keyed by symbol id.
+ *
+ * The first `envInlineVariables` variables are stored inline and searched linearly, so small scopes never allocate.
+ * Larger scopes move to a table allocated from the region, probed linearly and kept at most 3/4 full.
+ * Variables are never removed, a scope only grows until it is destroyed.
+ */
+class Bindings {
+public:
+  /**
+   * @brief A variable, its symbol id and constness packed into one key.
+   */
+  typedef struct Binding {
+    uint16_t key;         ///< The symbol id, with `constFlag` set for constants.
+    Values::Value value;  ///< The value of the variable.
+
+    constexpr Binding()
+      : key(emptyKey) {}
+
+    uint16_t symbol() const {
+      return key & ~constFlag;
+    }
+
+    bool isConst() const {
+      return key & constFlag;
+    }
+  } Binding;
+
+  Bindings()
+    : table(nullptr), capacity(0), count(0) {}
+
+  ~Bindings();
+
+  // Delete copy constructor and copy assignment operator
+  Bindings(const Bindings&) = delete;
+  Bindings& operator=(const Bindings&) = delete;
+
+  /**
+   * @brief Looks up a variable of this scope.
+   * @param symbol The symbol id of the variable.
+   * @return The variable or nullptr if it is not declared in this scope.
+   */
+  Binding* find(uint16_t symbol);
+
+  /**
+   * @brief Adds a variable to this scope, pointers to other variables may be invalidated.
+   * @param symbol The symbol id of the variable.
+   * @param constant Whether the variable is constant.
+   * @return The new variable holding null, nullptr if the variable is already declared in this scope.
+   */
+  Binding* insert(uint16_t symbol, bool constant);
+
+  /**
+   * @brief Returns the position of a variable of this scope, which stays valid until the scope grows.
+   */
+  uint16_t slotOf(const Binding* binding) const {
+    return binding - (table == nullptr ? inlineBindings : table);
+  }
+
+  /**
+   * @brief Looks up a variable at a position returned by `slotOf` before.
+   * @param slot The position of the variable.
+   * @param symbol The symbol id of the variable.
+   * @return The variable or nullptr if the position does not hold it anymore.
+   */
+  Binding* at(uint16_t slot, uint16_t symbol) {
+    if (slot >= (table == nullptr ? count : capacity)) {
+      return nullptr;
+    }
+    Binding* binding = table == nullptr ? &inlineBindings[slot] : &table[slot];
+    return binding->key != emptyKey && binding->symbol() == symbol ? binding : nullptr;
+  }
+
+  /**
+   * @brief Returns the number of variables.
+   */
+  uint16_t size() const {
+    return count;
+  }
+
+  static const uint16_t constFlag = 0x8000;      /**< Marks constants in `Binding::key`, symbol ids use the lower 15 bits */
+  static const uint16_t emptyKey = UINT16_MAX;   /**< Marks an empty slot of the table */
+
+private:
+  /**
+   * @brief Moves all variables to a table with twice the capacity.
+   */
+  void grow();
+
+  Binding inlineBindings[envInlineVariables];  /**< The variables while there are at most `envInlineVariables` */
+  Binding* table;                              /**< The hash table once there are more, nullptr before */
+  uint16_t capacity;                           /**< The capacity of `table`, a power of two */
+  uint16_t count;                              /**< The number of variables */
+};
@@ -0,0 +1,46 @@
+#include "Builtins.h"
+
+Bindings::Binding Builtins::slots[Builtins::count];
+
+uint8_t Builtins::find(const char* name) {
+  uint8_t low = 0;
+  uint8_t high = count;
+  while (low < high) {
+    uint8_t mid = (low + high) / 2;
+    int cmp = strcmp_P(name, table[mid].name);
+    if (cmp == 0) {
+      return mid;
+    }
+    if (cmp < 0) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return notFound;
+}
+
+Values::Value Builtins::value(uint8_t id) {
+  switch ((Values::ValueType)pgm_read_byte(&table[id].type)) {
+    case Values::ValueType::Boolean:
+      return Values::Value::makeBoolean(pgm_read_byte(&table[id].boolean));
+    case Values::ValueType::NativeFn:
+      return Values::Value::makeNativeFn(id, reinterpret_cast<Values::NativeFunction>(pgm_read_ptr(&table[id].fn)));
+    default:
+      return Values::Value::makeNull();
+  }
+}
+
+Bindings::Binding* Builtins::resolve(uint16_t symbol) {
+  uint8_t id = find(Symbols::name(symbol));
+  if (id == notFound) {
+    return nullptr;
+  }
+
+  Bindings::Binding& slot = slots[id];
+  if (slot.key == Bindings::emptyKey) {
+    slot.key = symbol | Bindings::constFlag;
+    slot.value = value(id);
+  }
+  return &slot;
+}
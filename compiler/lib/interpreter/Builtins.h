@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Bindings.h"
+#include "Constants.h"
+#include "NativeBinding.h"
+#include "NativeFunctions.h"
+#include "PadsComm.h"
+#include "Symbols.h"
+#include "Values.h"
+
+/**
+ * @brief A builtin constant or native function, its index in `Builtins::table` is its builtin id.
+ */
+typedef struct Builtin {
+  char name[maxBuiltinNameLength + 1];  ///< The name, stored inline so it stays in flash together with the entry.
+  Values::ValueType type;               ///< Boolean, Null or NativeFn.
+  bool boolean;                         ///< The value, if `type` is Boolean.
+  Values::NativeFunction fn;            ///< The generated native function, if `type` is NativeFn.
+
+  /**
+   * @brief Creates the table entry of a native function.
+   */
+  template<size_t N>
+  static constexpr Builtin native(const char (&name)[N], Values::NativeFunction fn) {
+    Builtin builtin = entry(name, Values::ValueType::NativeFn);
+    builtin.fn = fn;
+    return builtin;
+  }
+
+  /**
+   * @brief Creates the table entry of a constant.
+   */
+  template<size_t N>
+  static constexpr Builtin constant(const char (&name)[N], Values::ValueType type, bool boolean = false) {
+    Builtin builtin = entry(name, type);
+    builtin.boolean = boolean;
+    return builtin;
+  }
+
+private:
+  template<size_t N>
+  static constexpr Builtin entry(const char (&name)[N], Values::ValueType type) {
+    static_assert(N <= maxBuiltinNameLength + 1, "Builtin name is too long");
+    Builtin builtin = {};
+    for (size_t i = 0; i < N; i++) {
+      builtin.name[i] = name[i];
+    }
+    builtin.type = type;
+    return builtin;
+  }
+} Builtin;
+
+/**
+ * @class Builtins
+ * @brief The table of all builtins, resolved entirely at compile time and stored in flash.
+ *
+ * The table is the implicit outermost scope of every environment, names no environment declares are looked up here
+ * by binary search. Creating an environment therefore costs nothing for the builtins.
+ * A builtin's value is only materialized the first time it is resolved, into a static slot that never allocates.
+ *
+ * New builtins are added to the table, which has to stay sorted by name.
+ */
+class Builtins {
+public:
+  static constexpr Builtin table[] PROGMEM = {
+    Builtin::native("delay", &NativeBinding::bindNative<&PadsComm::waitWithCancelCheck>),
+    Builtin::constant("false", Values::ValueType::Boolean, false),
+    Builtin::native("isPadOccupied", &NativeBinding::bindNative<&PadsComm::isPadOccupied>),
+    Builtin::constant("null", Values::ValueType::Null),
+    Builtin::native("playCorrectActionJingle", &NativeBinding::bindNative<&PadsComm::playCorrectActionJingle, NativeBinding::OptionalPad>),
+    Builtin::native("playLoserJingle", &NativeBinding::bindNative<&PadsComm::playLoserJingle, NativeBinding::OptionalPad>),
+    Builtin::native("playSound", &NativeBinding::bindNative<&NativeFunctions::playSound>),
+    Builtin::native("playWinnerJingle", &NativeBinding::bindNative<&PadsComm::playWinnerJingle, NativeBinding::OptionalPad>),
+    Builtin::native("playWrongActionJingle", &NativeBinding::bindNative<&PadsComm::playWrongActionJingle, NativeBinding::OptionalPad>),
+    Builtin::native("print", &NativeBinding::bindNative<&NativeFunctions::print>),
+    Builtin::native("random", &NativeBinding::bindNative<&NativeFunctions::rnd>),
+    Builtin::constant("true", Values::ValueType::Boolean, true),
+    Builtin::native("waitForPlayerOnAnyPad", &NativeBinding::bindNative<&PadsComm::waitForPlayerOnAnyPad>),
+    Builtin::native("waitForPlayerOnPad", &NativeBinding::bindNative<&PadsComm::waitForPlayerOnPad, NativeBinding::OptionalPad>),
+    Builtin::native("waitForPlayersOnAllActivePads", &NativeBinding::bindNative<&PadsComm::waitForPlayersOnAllActivePads>),
+  };
+
+  static constexpr uint8_t count = sizeof(table) / sizeof(table[0]);  ///< The number of builtins.
+  static_assert(count < Values::closureBuiltin, "Builtin ids must not collide with the closure marker");
+
+  static const uint8_t notFound = UINT8_MAX; /**< Returned by `find` for names that are not builtins */
+
+  /**
+   * @brief Looks up a builtin by name.
+   * @param name The name of the builtin.
+   * @return The builtin id or `notFound`.
+   */
+  static uint8_t find(const char* name);
+
+  /**
+   * @brief Creates the value of a builtin.
+   * @param id The builtin id.
+   */
+  static Values::Value value(uint8_t id);
+
+  /**
+   * @brief Resolves a variable from the builtins.
+   * @param symbol The symbol id of the variable.
+   * @return The constant variable of the builtin or nullptr if the name is not a builtin.
+   */
+  static Bindings::Binding* resolve(uint16_t symbol);
+
+  /**
+   * @brief Returns the builtin id of a variable returned by `resolve`.
+   */
+  static uint8_t slotOf(const Bindings::Binding* binding) {
+    return binding - slots;
+  }
+
+  /**
+   * @brief Looks up a builtin that was resolved before by its id.
+   * @param id The builtin id.
+   * @param symbol The symbol id of the variable.
+   * @return The variable or nullptr if the builtin is not resolved as that symbol.
+   */
+  static Bindings::Binding* at(uint16_t id, uint16_t symbol) {
+    return id < count && slots[id].key != Bindings::emptyKey && slots[id].symbol() == symbol ? &slots[id] : nullptr;
+  }
+
+  /**
+   * @brief Checks that the table is sorted by name, as the binary search of `find` requires.
+   */
+  static constexpr bool isSorted() {
+    for (uint8_t i = 1; i < count; i++) {
+      const char* a = table[i - 1].name;
+      const char* b = table[i].name;
+      while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+      }
+      if ((unsigned char)*a >= (unsigned char)*b) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  static Bindings::Binding slots[count]; /**< The materialized builtins, indexed by builtin id */
+};
+
+static_assert(Builtins::isSorted(), "Builtins must be sorted by name for the binary search");
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <new>
+
+#include "ConstantPool.h"
+#include "Region.h"
+#include "Values.h"
+
+/**
+ * @class ConstantTable
+ * @brief The runtime values of the constant pool of the running program.
+ *
+ * Every string of the pool is turned into a value once, when the program starts, string literals then evaluate to
+ * a copy of their value. Long strings are immortal strings referencing the characters of the pool, so no copy
+ * touches the heap or a reference count.
+ * The pool is owned by the program, so the program must outlive every value evaluated from it, including copies
+ * stored in environments, like it must for function values.
+ * The values are allocated in one buffer from the `Region` of the running game.
+ */
+class ConstantTable {
+public:
+  ConstantTable()
+    : values(nullptr), count(0), pool(nullptr) {}
+
+  ~ConstantTable() {
+    clear();
+  }
+
+  // Delete copy constructor and copy assignment operator
+  ConstantTable(const ConstantTable&) = delete;
+  ConstantTable& operator=(const ConstantTable&) = delete;
+
+  /**
+   * @brief Creates the values of a constant pool, does nothing if they already exist.
+   * @param constants The constant pool of the program.
+   */
+  void load(const ConstantPool& constants) {
+    // a parser adds the literals of later inputs to the same pool
+    if (pool == &constants && count == constants.size()) {
+      return;
+    }
+
+    clear();
+    pool = &constants;
+    if (constants.size() == 0) {
+      return;
+    }
+
+    values = static_cast<Values::Value*>(Region::allocateBuffer(constants.size() * sizeof(Values::Value)));
+    for (count = 0; count < constants.size(); count++) {
+      ::new (&values[count]) Values::Value(Values::Value::makeImmortalString(constants.at(count)));
+    }
+  }
+
+  /**
+   * @brief Returns the value of a pool entry, `index` must be smaller than `size()`.
+   */
+  const Values::Value& at(uint16_t index) const {
+    return values[index];
+  }
+
+  /**
+   * @brief Returns the number of loaded values.
+   */
+  uint16_t size() const {
+    return count;
+  }
+
+private:
+  Values::Value* values;      /**< The buffer for the values, nullptr while no pool is loaded */
+  uint16_t count;             /**< The number of values */
+  const ConstantPool* pool;   /**< The loaded pool */
+
+  /**
+   * @brief Destroys the values of the loaded pool.
+   */
+  void clear() {
+    if (values != nullptr) {
+      for (uint16_t i = 0; i < count; i++) {
+        values[i].~Value();
+      }
+      Region::deallocateBuffer(values, count * sizeof(Values::Value));
+    }
+    values = nullptr;
+    count = 0;
+    pool = nullptr;
+  }
+};
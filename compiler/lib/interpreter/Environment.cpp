@@ -1,64 +1,78 @@
 #include "Environment.h"
 
-std::unique_ptr<Values::RuntimeVal> Environment::declareVar(const char* varName, std::unique_ptr<Values::RuntimeVal>&& value, bool constant) {
-  auto [it, insertionSuccessful] = variables.insert({ varName, value->clone() });
+const Values::Value& Environment::declareVar(uint16_t symbol, Values::Value&& value, bool constant) {
+  // the builtins are the outermost scope, so global variables must not redeclare them
+  bool isBuiltin = parent == nullptr && Builtins::find(Symbols::name(symbol)) != Builtins::notFound;
+  Bindings::Binding* binding = isBuiltin ? nullptr : variables.insert(symbol, constant);
 
-  if (!insertionSuccessful) {
-    ErrorHandler::restart("Cannot declare variable \"", varName, "\", as it is already defined");
+  if (binding == nullptr) {
+    ErrorHandler::restart("Cannot declare variable \"", Symbols::name(symbol), "\", as it is already defined");
   }
 
-  if (constant) {
-    constants.insert(varName);
+  uint8_t depth;
+  uint16_t slot;
+  if (parent != nullptr && parent->find(symbol, depth, slot) != nullptr) {
+    // positions cached before in this scope may skip the new variable
+    shadowCount++;
   }
 
-  return std::move(value);
+  binding->value = std::move(value);
+  return binding->value;
 }
 
-std::unique_ptr<Values::RuntimeVal> Environment::assignVar(const char* varName, std::unique_ptr<Values::RuntimeVal>&& value) {
-  Environment* env = this->resolve(varName);
-  if (env->constants.find(varName) != env->constants.end()) {
-    ErrorHandler::restart("Trying to reassign const variable");
-  }
-  env->variables[varName] = value->clone();
-  return std::move(value);
+const Values::Value& Environment::assignVar(uint16_t symbol, Values::Value&& value) {
+  Values::Value& stored = lookupMutableVar(symbol);
+  stored = std::move(value);
+  return stored;
 }
 
-std::unique_ptr<Values::RuntimeVal> Environment::lookupVar(const char* varName) {
-  Environment* env = resolve(varName);
-  return env->variables[varName]->clone();
+Values::Value& Environment::lookupMutableVar(uint16_t symbol) {
+  Bindings::Binding& binding = resolveBinding(symbol);
+  if (binding.isConst()) {
+    ErrorHandler::restart("Trying to reassign const variable");
+  }
+  return binding.value;
 }
 
-Environment* Environment::resolve(const char* varName) {
-  if (variables.find(varName) != variables.end()) {
-    return this;
+Bindings::Binding& Environment::resolveBinding(uint16_t symbol, uint8_t& depth, uint16_t& slot) {
+  Bindings::Binding* binding = find(symbol, depth, slot);
+  if (binding != nullptr) {
+    return *binding;
   }
 
-  if (parent == nullptr) {
-    ErrorHandler::restart("Cannot resolve variable \"", varName, "\"");
-  }
+  ErrorHandler::restart("Cannot resolve variable \"", Symbols::name(symbol), "\"");
 
-  return parent->resolve(varName);
+  // not reached, restarting does not return
+  static Bindings::Binding unresolved;
+  return unresolved;
 }
 
-void Environment::createGlobalEnv() {
-  declareVar("true", std::make_unique<Values::BooleanVal>(true), true);
-  declareVar("false", std::make_unique<Values::BooleanVal>(false), true);
-  declareVar("null", std::make_unique<Values::NullVal>(), true);
-
-  declareVar("print", std::make_unique<Values::NativeFnVal>(NativeFunctions::print), true);
-  declareVar("random", std::make_unique<Values::NativeFnVal>(NativeFunctions::rnd), true);
-
-  declareVar("playSound", std::make_unique<Values::NativeFnVal>(NativeFunctions::playSound), true);
-  declareVar("playCorrectActionJingle", std::make_unique<Values::NativeFnVal>(NativeFunctions::playCorrectActionJingle), true);
-  declareVar("playWrongActionJingle", std::make_unique<Values::NativeFnVal>(NativeFunctions::playWrongActionJingle), true);
-  declareVar("playWinnerJingle", std::make_unique<Values::NativeFnVal>(NativeFunctions::playWinnerJingle), true);
-  declareVar("playLoserJingle", std::make_unique<Values::NativeFnVal>(NativeFunctions::playLoserJingle), true);
+Bindings::Binding* Environment::bindingAt(uint8_t depth, uint16_t slot, uint16_t symbol) {
+  if (depth == builtinsDepth) {
+    return Builtins::at(slot, symbol);
+  }
 
-  declareVar("waitForPlayerOnPad", std::make_unique<Values::NativeFnVal>(NativeFunctions::waitForPlayerOnPad), true);
-  declareVar("waitForPlayerOnAnyPad", std::make_unique<Values::NativeFnVal>(NativeFunctions::waitForPlayerOnAnyPad), true);
-  declareVar("waitForPlayersOnAllActivePads", std::make_unique<Values::NativeFnVal>(NativeFunctions::waitForPlayersOnAllActivePads), true);
+  Environment* env = this;
+  for (; depth > 0 && env != nullptr; depth--) {
+    env = env->parent;
+  }
+  return env != nullptr ? env->variables.at(slot, symbol) : nullptr;
+}
 
-  declareVar("delay", std::make_unique<Values::NativeFnVal>(NativeFunctions::waitWithCancelCheck), true);
+Bindings::Binding* Environment::find(uint16_t symbol, uint8_t& depth, uint16_t& slot) {
+  depth = 0;
+  for (Environment* env = this; env != nullptr; env = env->parent, depth++) {
+    Bindings::Binding* binding = env->variables.find(symbol);
+    if (binding != nullptr) {
+      slot = env->variables.slotOf(binding);
+      return binding;
+    }
+  }
 
-  declareVar("isPadOccupied", std::make_unique<Values::NativeFnVal>(NativeFunctions::isPadOccupied), true);
-}
\ No newline at end of file
+  Bindings::Binding* builtin = Builtins::resolve(symbol);
+  if (builtin != nullptr) {
+    depth = builtinsDepth;
+    slot = Builtins::slotOf(builtin);
+  }
+  return builtin;
+}
@@ -1,29 +1,32 @@
 #pragma once
 
-#include <map>
-#include <set>
 #include <memory>
 
+#include "Bindings.h"
+#include "Builtins.h"
 #include "Constants.h"
 #include "ErrorHandler.h"
 #include "Values.h"
 #include "NativeFunctions.h"
 #include "PadsComm.h"
+#include "Region.h"
+#include "Symbols.h"
 
 /**
  * @class Environment
  * @brief Represents an environment for managing variables, functions, and scope resolution.
  * 
  * It supports variable declarations, assignments, lookups, and handles parent-child environment resolution.
+ * Variables are keyed by their interned symbol id, every operation is also available by name, which interns it first.
+ * Environments and their variables are allocated from the `Region` of the running game.
  */
-class Environment {
+class Environment : public RegionAllocated {
 public:
   /**
-   * @brief Default constructor. Initializes an environment with no parent and creates global variables.
+   * @brief Default constructor. Initializes a global environment, which resolves the builtins from its parent.
    */
   Environment()
-    : parent(nullptr) {
-    createGlobalEnv();
+    : shadowCount(0), parent(nullptr) {
   }
 
   /**
@@ -32,60 +35,140 @@ public:
    * @param _parent The parent environment this instance is resolving from.
    */
   Environment(Environment* _parent)
-    : parent(_parent) {
+    : shadowCount(_parent->shadowCount), parent(_parent) {
   }
 
   /**
    * @brief Declares a variable with a given name, value, and constant flag.
    * 
    * @param varName The name of the variable.
-   * @param value The value of the variable.
+   * @param value The value of the variable, moved into the environment.
    * @param constant Boolean flag indicating whether the variable is constant.
-   * @return The declared variable's value.
+   * @return The stored value of the declared variable.
    * @throws ErrorHandler::restart if the variable already exists in the current environment.
    */
-  std::unique_ptr<Values::RuntimeVal> declareVar(const char* varName, std::unique_ptr<Values::RuntimeVal>&& value, bool constant);
+  const Values::Value& declareVar(const char* varName, Values::Value&& value, bool constant) {
+    return declareVar(Symbols::intern(varName), std::move(value), constant);
+  }
+
+  const Values::Value& declareVar(uint16_t symbol, Values::Value&& value, bool constant);
 
   /**
    * @brief Assigns a value to an existing variable in the environment.
    * 
    * @param varName The name of the variable.
-   * @param value The new value to assign to the variable.
-   * @return The assigned value.
+   * @param value The new value to assign to the variable, moved into the environment.
+   * @return The stored value of the assigned variable.
    * @throws ErrorHandler::restart if attempting to reassign a constant variable.
    */
-  std::unique_ptr<Values::RuntimeVal> assignVar(const char* varName, std::unique_ptr<Values::RuntimeVal>&& value);
+  const Values::Value& assignVar(const char* varName, Values::Value&& value) {
+    return assignVar(Symbols::intern(varName), std::move(value));
+  }
+
+  const Values::Value& assignVar(uint16_t symbol, Values::Value&& value);
 
   /**
-   * @brief Looks up the value of a variable.
+   * @brief Looks up the value of a variable without copying it.
+   * 
+   * The reference is borrowed, it is only valid until the variable is assigned, another variable is declared in its
+   * environment or the environment is destroyed.
+   * Copy the value if it has to outlive the current expression.
    * 
    * @param varName The name of the variable.
-   * @return The value of the variable.
+   * @return The stored value of the variable.
    * @throws ErrorHandler::restart if the variable cannot be resolved in the current or parent environments.
    */
-  std::unique_ptr<Values::RuntimeVal> lookupVar(const char* varName);
+  const Values::Value& lookupVar(const char* varName) {
+    return lookupVar(Symbols::intern(varName));
+  }
+
+  const Values::Value& lookupVar(uint16_t symbol) {
+    return resolveBinding(symbol).value;
+  }
 
   /**
-   * @brief Resolves a variable from the current environment or any parent environment.
+   * @brief Looks up the stored value of a variable, so it can be modified in place.
+   * 
+   * The reference stays valid until another variable is declared in the owning environment.
    * 
    * @param varName The name of the variable.
-   * @return The environment in which the variable is found.
+   * @return A reference to the stored value of the variable.
+   * @throws ErrorHandler::restart if the variable cannot be resolved or is constant.
+   */
+  Values::Value& lookupMutableVar(const char* varName) {
+    return lookupMutableVar(Symbols::intern(varName));
+  }
+
+  Values::Value& lookupMutableVar(uint16_t symbol);
+
+  /**
+   * @brief Resolves a variable from the current environment, any parent environment or the builtins.
+   * 
+   * @param symbol The symbol id of the variable.
+   * @return The variable.
+   * @throws ErrorHandler::restart if the variable cannot be resolved in any environment.
+   */
+  Bindings::Binding& resolveBinding(uint16_t symbol) {
+    uint8_t depth;
+    uint16_t slot;
+    return resolveBinding(symbol, depth, slot);
+  }
+
+  /**
+   * @brief Resolves a variable and reports where it was found, so the position can be cached.
+   * 
+   * @param symbol The symbol id of the variable.
+   * @param depth Set to the number of parent environments walked, or `builtinsDepth` for builtins.
+   * @param slot Set to the position of the variable in the environment it was found in.
+   * @return The variable.
    * @throws ErrorHandler::restart if the variable cannot be resolved in any environment.
    */
-  Environment* resolve(const char* varName);
+  Bindings::Binding& resolveBinding(uint16_t symbol, uint8_t& depth, uint16_t& slot);
+
+  /**
+   * @brief Looks up a variable at a position reported by `resolveBinding` before.
+   * 
+   * The result is only the variable `resolveBinding` would return if `shadowCount` did not change in between.
+   * 
+   * @param depth The number of parent environments to walk.
+   * @param slot The position of the variable in that environment.
+   * @param symbol The symbol id of the variable.
+   * @return The variable or nullptr if the position does not hold it anymore.
+   */
+  Bindings::Binding* bindingAt(uint8_t depth, uint16_t slot, uint16_t symbol);
+
+  /**
+   * @brief Returns the outermost environment, the one functions are declared in.
+   */
+  Environment* global() {
+    Environment* env = this;
+    while (env->parent != nullptr) {
+      env = env->parent;
+    }
+    return env;
+  }
+
+  static const uint8_t builtinsDepth = UINT8_MAX - 1; /**< The depth reported for builtins */
+
+  /**
+   * @brief The number of declarations shadowing a variable of a parent environment or a builtin, in this environment
+   * and, as of its creation, its parents.
+   * 
+   * Parents cannot declare variables while a nested environment is active, so only declarations in this environment
+   * change it. Positions reported for the same count are valid, a shadowing declaration only changes the count of the
+   * scopes that may now skip a cached variable, so the positions cached in other scopes stay valid.
+   */
+  uint16_t shadowCount;
 
   Values values; /**< The container for values in the environment. */
 private:
   /**
-   * @brief  Creates global environment variables and functions.
-   * 
-   * Initializes the built-in variables like 'true', 'false', and 'null',
-   * and declares the native functions like 'print', 'playSound', etc.
+   * @brief Resolves a variable like `resolveBinding`, without restarting if it is not found.
+   * @return The variable or nullptr.
    */
-  void createGlobalEnv();
+  Bindings::Binding* find(uint16_t symbol, uint8_t& depth, uint16_t& slot);
 
   Environment* parent;             /**< The parent environment for resolution of variables. */
 
-  std::map<String, std::unique_ptr<Values::RuntimeVal>> variables; /**< Map of variables in the environment. */
-  std::set<String> constants;                                      /**< Set of constant variables that cannot be reassigned. */
+  Bindings variables;              /**< The variables of the environment, including whether they are constant. */
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Constants.h"
+#include "Environment.h"
+#include "ErrorHandler.h"
+#include "Region.h"
+
+/**
+ * @class FrameStack
+ * @brief Preallocated storage for the scopes of blocks and the frames of function calls, pushed and popped in stack order.
+ *
+ * Scopes always end in the reverse order they were started, so they are constructed in place in one contiguous
+ * buffer instead of being allocated one by one. The buffer is taken from the region once, when the first scope is pushed.
+ */
+class FrameStack {
+public:
+  FrameStack()
+    : frames(nullptr), depth(0) {}
+
+  ~FrameStack() {
+    while (depth > 0) {
+      pop();
+    }
+    if (frames != nullptr) {
+      Region::deallocateBuffer(frames, maxScopeDepth * sizeof(Environment));
+    }
+  }
+
+  // Delete copy constructor and copy assignment operator
+  FrameStack(const FrameStack&) = delete;
+  FrameStack& operator=(const FrameStack&) = delete;
+
+  /**
+   * @brief Starts a new scope.
+   * @param parent The enclosing environment.
+   * @return The environment of the new scope, valid until it is popped.
+   */
+  Environment* push(Environment* parent) {
+    if (frames == nullptr) {
+      frames = static_cast<Environment*>(Region::allocateBuffer(maxScopeDepth * sizeof(Environment)));
+    }
+    if (depth >= maxScopeDepth) {
+      ErrorHandler::restart("Scopes are nested too deeply");
+    }
+    return ::new (&frames[depth++]) Environment(parent);
+  }
+
+  /**
+   * @brief Ends the innermost scope.
+   */
+  void pop() {
+    frames[--depth].~Environment();
+  }
+
+private:
+  Environment* frames; /**< The buffer for `maxScopeDepth` environments */
+  uint8_t depth;       /**< The number of active scopes */
+};
@@ -1,30 +1,62 @@
 #include "Interpreter.h"
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evaluate(const AstNodes::Stmt* astNode, Environment* env) {
-  yield();
+Values::Value Interpreter::evaluate(const AstNodes::Stmt* astNode, Environment* env) {
+  Scheduler::step();
+  switch (astNode->kind) {
+    case AstNodes::NodeType::Program:
+      constants.load(static_cast<const AstNodes::Program*>(astNode)->constants);
+      // fall through
+    case AstNodes::NodeType::BlockStmt:
+    case AstNodes::NodeType::IfStmt:
+    case AstNodes::NodeType::WhileStmt:
+    case AstNodes::NodeType::ForStmt:
+    case AstNodes::NodeType::BreakStmt:
+    case AstNodes::NodeType::ContinueStmt:
+    case AstNodes::NodeType::ReturnStmt:
+      {
+        Values::Value result;
+        if (execute(astNode, env, result) == Completion::Return) {
+          ErrorHandler::restart("A return statement may only be used within a function");
+        }
+        return result;
+      }
+    default:
+      break;
+  }
+
+  // expressions are still evaluated recursively, so their depth is bounded separately
+  if (expressionDepth >= maxExpressionDepth) {
+    ErrorHandler::restart("Expression is nested too deeply");
+  }
+  expressionDepth++;
+  Values::Value result = evalExpr(astNode, env);
+  expressionDepth--;
+  return result;
+}
+
+Values::Value Interpreter::evalExpr(const AstNodes::Stmt* astNode, Environment* env) {
   switch (astNode->kind) {
     case AstNodes::NodeType::NumericLiteral:
-      return std::make_unique<Values::NumberVal>(static_cast<const AstNodes::NumericLiteral*>(astNode)->num);
+      {
+        const AstNodes::NumericLiteral* numLit = static_cast<const AstNodes::NumericLiteral*>(astNode);
+        return numLit->fixed ? Values::Value::makeFixed(numLit->num) : Values::Value::makeNumber(numLit->num);
+      }
     case AstNodes::NodeType::StringLiteral:
-      return std::make_unique<Values::StringVal>(static_cast<const AstNodes::StringLiteral*>(astNode)->value);
+      return evalStringLiteral(static_cast<const AstNodes::StringLiteral*>(astNode));
     case AstNodes::NodeType::Identifier:
       return evalIdentifier(static_cast<const AstNodes::Identifier*>(astNode), env);
     case AstNodes::NodeType::BinaryExpr:
       return evalBinaryExpr(static_cast<const AstNodes::BinaryExpr* >(astNode), env);
     case AstNodes::NodeType::VarDeclaration:
       return evalVarDeclaration(static_cast<const AstNodes::VarDeclaration* >(astNode), env);
-    case AstNodes::NodeType::IfStmt:
-      return evalIfStmt(static_cast<const AstNodes::IfStmt* >(astNode), env);
-    case AstNodes::NodeType::WhileStmt:
-      return evalWhileStmt(static_cast<const AstNodes::WhileStmt*>(astNode), env);
-    case AstNodes::NodeType::BreakStmt:
-      return evalBreakStmt(static_cast<const AstNodes::BreakStmt*>(astNode), env);
-    case AstNodes::NodeType::BlockStmt:
-      return evalBlockStmt(static_cast<const AstNodes::BlockStmt* >(astNode), env);
+    case AstNodes::NodeType::FunctionDeclaration:
+      return evalFunctionDeclaration(static_cast<const AstNodes::FunctionDeclaration*>(astNode), env);
     case AstNodes::NodeType::LogicalExpr:
       return evalLogicalExpr(static_cast<const AstNodes::LogicalExpr* >(astNode), env);
     case AstNodes::NodeType::AssignmentExpr:
       return evalAssignmentExpr(static_cast<const AstNodes::AssignmentExpr*>(astNode), env);
+    case AstNodes::NodeType::UpdateExpr:
+      return evalUpdateExpr(static_cast<const AstNodes::UpdateExpr*>(astNode), env);
     case AstNodes::NodeType::ObjectLiteral:
       return evalObjectExpr(static_cast<const AstNodes::ObjectLiteral*>(astNode), env);
     case AstNodes::NodeType::ArrayLiteral:
@@ -33,436 +65,793 @@ std::unique_ptr<Values::RuntimeVal> Interpreter::evaluate(const AstNodes::Stmt*
       return evalCallExpr(static_cast<const AstNodes::CallExpr*>(astNode), env);
     case AstNodes::NodeType::MemberExpr:
       return evalMemberExpr(static_cast<const AstNodes::MemberExpr*>(astNode), env);
-    case AstNodes::NodeType::Program:
-      return evalProgram(static_cast<const AstNodes::Program*>(astNode), env);
+    default:
+      ErrorHandler::restart("Cannot evaluate statement as an expression");
+      return Values::Value::makeNull();
   }
-
-  return std::make_unique<Values::NullVal>();
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalProgram(const AstNodes::Program* program, Environment* env) {
-  std::unique_ptr<Values::RuntimeVal> lastEvaluated = std::make_unique<Values::NullVal>();
+Interpreter::Completion Interpreter::execute(const AstNodes::Stmt* stmt, Environment* env, Values::Value& lastEvaluated) {
+  // a nested run, e.g. from a native function, only executes the tasks it started itself
+  uint8_t base = tasks.size();
+  Completion completion = schedule(stmt, env, lastEvaluated);
 
-  for (size_t i = 0; i < program->body.size(); i++) {
-    lastEvaluated = evaluate(program->body[i].get(), env);
-    if (lastEvaluated->type == Values::ValueType::Break) {
-      ErrorHandler::restart("A break statement may only be used within a loop");
+  while (true) {
+    if (completion != Completion::Normal) {
+      completion = unwind(completion, base);
+      if (completion == Completion::Return) {
+        return completion;
+      }
+    }
+    if (tasks.size() == base) {
+      return Completion::Normal;
     }
-  }
 
-  return lastEvaluated;
-}
+    Scheduler::step();
+    TaskStack::Task& task = tasks.top();
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalVarDeclaration(const AstNodes::VarDeclaration* declaration, Environment* env) {
-  Serial.println("evalVarDeclaration");
-  std::unique_ptr<Values::RuntimeVal> val = declaration->value ? evaluate(declaration->value.get(), env) : std::make_unique<Values::NullVal>();
-  return env->declareVar(declaration->ident, std::move(val), declaration->constant);
-}
-
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalIfStmt(const AstNodes::IfStmt* ifStmt, Environment* env) {
-  std::unique_ptr<Values::RuntimeVal> result = evaluate(ifStmt->test.get(), env);
-  Serial.println("Evaluated test of if statement");
-  if (result->type != Values::ValueType::Boolean) {
-    ErrorHandler::restart("Expected boolean value in if statement condition");
-  } else {
-    if (static_cast<Values::BooleanVal*>(result.get())->value) {
-      Serial.println("Evaluating consequent block");
-      return evalBlockStmt(ifStmt->consequent.get(), env);
-    } else if (ifStmt->alternate != nullptr) {
-      Serial.println("Evaluating alternate block");
-      return evalBlockStmt(ifStmt->alternate.get(), env);
+    switch (task.stmt->kind) {
+      case AstNodes::NodeType::Program:
+        {
+          const AstNodes::Program* program = static_cast<const AstNodes::Program*>(task.stmt);
+          if (task.next < program->body.size()) {
+            completion = schedule(program->body[task.next++].get(), task.env, lastEvaluated);
+          } else {
+            endTask();
+          }
+          break;
+        }
+      case AstNodes::NodeType::BlockStmt:
+        {
+          const AstNodes::BlockStmt* block = static_cast<const AstNodes::BlockStmt*>(task.stmt);
+          if (task.next < block->body.size()) {
+            completion = schedule(block->body[task.next++].get(), task.env, lastEvaluated);
+          } else {
+            endTask();
+          }
+          break;
+        }
+      case AstNodes::NodeType::WhileStmt:
+        {
+          const AstNodes::WhileStmt* whileStmt = static_cast<const AstNodes::WhileStmt*>(task.stmt);
+          if (evalCondition(whileStmt->test.get(), task.env, "Expected boolean value in while statement condition")) {
+            completion = schedule(whileStmt->body.get(), task.env, lastEvaluated);
+          } else {
+            Serial.println("While test evaluated to false");
+            endTask();
+          }
+          break;
+        }
+      case AstNodes::NodeType::ForStmt:
+        {
+          const AstNodes::ForStmt* forStmt = static_cast<const AstNodes::ForStmt*>(task.stmt);
+          Values::Value& counter = task.counter->value;
+          if (task.next > 0) {
+            counter.number++;
+          }
+          task.next = 1;
+          if (counter.number < task.bound) {
+            completion = schedule(forStmt->body.get(), task.env, lastEvaluated);
+          } else {
+            endTask();
+          }
+          break;
+        }
+      default:
+        endTask();
+        break;
     }
   }
-  return std::make_unique<Values::NullVal>();
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalWhileStmt(const AstNodes::WhileStmt* whileStmt, Environment* env) {
-  std::unique_ptr<Values::RuntimeVal> testResult = evaluate(whileStmt->test.get(), env);
-
-  if (testResult->type != Values::ValueType::Boolean) {
-    ErrorHandler::restart("Expected boolean value in while statement condition");
-  } else {
-    
-    AstNodes::BlockStmt* whileStmtBody = whileStmt->body.get();
-    std::vector<std::unique_ptr<AstNodes::Stmt>>& blockStmtBody = whileStmtBody->body;
-    std::unique_ptr<Values::RuntimeVal> result;
-
-    while (true) {
-      
-      std::unique_ptr<Values::RuntimeVal> testResult = evaluate(whileStmt->test.get(), env);
-      if (!static_cast<Values::BooleanVal*>(testResult.get())->value) {
-        Serial.println("While test evaluated to false");
-        break;
+Interpreter::Completion Interpreter::schedule(const AstNodes::Stmt* stmt, Environment* env, Values::Value& lastEvaluated) {
+  switch (stmt->kind) {
+    case AstNodes::NodeType::Program:
+      tasks.push(stmt, env, false);
+      return Completion::Normal;
+    case AstNodes::NodeType::BlockStmt:
+      {
+        Serial.println("evalBlockStmt");
+        // blocks without declarations cannot tell their scope apart from the enclosing one, so they do not get one
+        Environment* scope = static_cast<const AstNodes::BlockStmt*>(stmt)->declaresVariables ? frames.push(env) : env;
+        tasks.push(stmt, scope, scope != env);
+        return Completion::Normal;
       }
-
-      Environment* childEnv = new Environment(env);
-      for (size_t i = 0; i < blockStmtBody.size(); i++) {
-        result = evaluate(blockStmtBody[i].get(), childEnv);
-
-        if (result->type == Values::ValueType::Break) {
-          Serial.println("\"break\" found in \"while\" loop, jumping...");
-          delete childEnv;
-          return std::make_unique<Values::NullVal>();
+    case AstNodes::NodeType::WhileStmt:
+      // a loop evaluates to the last value of its body, null if the body never runs
+      lastEvaluated = Values::Value::makeNull();
+      tasks.push(stmt, env, false);
+      return Completion::Normal;
+    case AstNodes::NodeType::ForStmt:
+      {
+        const AstNodes::ForStmt* forStmt = static_cast<const AstNodes::ForStmt*>(stmt);
+        Values::Value start = evaluate(forStmt->start.get(), env);
+        Values::Value end = evaluate(forStmt->end.get(), env);
+        if (start.type != Values::ValueType::Number || end.type != Values::ValueType::Number) {
+          ErrorHandler::restart("Expected numbers as the bounds of a for statement range");
         }
+        // the loop variable is constant for the body, only the loop itself counts it up in place
+        Environment* scope = frames.push(env);
+        scope->declareVar(forStmt->ident, std::move(start), true);
+        // nothing else is declared in the loop scope, so the binding of the loop variable stays in place
+        Bindings::Binding* counter = &scope->resolveBinding(forStmt->ident);
+        lastEvaluated = Values::Value::makeNull();
+        tasks.push(stmt, scope, true, counter, end.number);
+        return Completion::Normal;
       }
-      delete childEnv;
+    case AstNodes::NodeType::IfStmt:
+      {
+        const AstNodes::IfStmt* ifStmt = static_cast<const AstNodes::IfStmt*>(stmt);
+        if (evalCondition(ifStmt->test.get(), env, "Expected boolean value in if statement condition")) {
+          Serial.println("Evaluating consequent block");
+          return schedule(ifStmt->consequent.get(), env, lastEvaluated);
+        } else if (ifStmt->alternate != nullptr) {
+          Serial.println("Evaluating alternate block");
+          return schedule(ifStmt->alternate.get(), env, lastEvaluated);
+        }
+        lastEvaluated = Values::Value::makeNull();
+        return Completion::Normal;
+      }
+    case AstNodes::NodeType::BreakStmt:
+      Serial.println("\"break\" found, jumping out of the loop...");
+      return Completion::Break;
+    case AstNodes::NodeType::ContinueStmt:
+      Serial.println("\"continue\" found, jumping to the next iteration...");
+      return Completion::Continue;
+    case AstNodes::NodeType::ReturnStmt:
+      {
+        Serial.println("\"return\" found, leaving the function...");
+        const AstNodes::ReturnStmt* returnStmt = static_cast<const AstNodes::ReturnStmt*>(stmt);
+        lastEvaluated = returnStmt->value ? evaluate(returnStmt->value.get(), env) : Values::Value::makeNull();
+        return Completion::Return;
+      }
+    default:
+      lastEvaluated = evaluate(stmt, env);
+      return Completion::Normal;
+  }
+}
+
+Interpreter::Completion Interpreter::unwind(Completion completion, uint8_t base) {
+  // the body of a call is executed by its own `execute`, so a return ends every task above `base`
+  while (tasks.size() > base) {
+    AstNodes::NodeType kind = tasks.top().stmt->kind;
+    if (completion != Completion::Return && (kind == AstNodes::NodeType::WhileStmt || kind == AstNodes::NodeType::ForStmt)) {
+      // a continue keeps the loop, which starts its next iteration as if the body had ended
+      if (completion == Completion::Break) {
+        endTask();
+      }
+      return Completion::Normal;
     }
+    endTask();
   }
 
-  return std::make_unique<Values::NullVal>();
+  if (completion == Completion::Break) {
+    ErrorHandler::restart("A break statement may only be used within a loop");
+  } else if (completion == Completion::Continue) {
+    ErrorHandler::restart("A continue statement may only be used within a loop");
+  }
+  return completion;
 }
 
-std::unique_ptr<Values::BreakVal> Interpreter::evalBreakStmt(const AstNodes::BreakStmt* breakStmt, Environment* env) {
-  Serial.println("evalBreakStmt");
-  return std::make_unique<Values::BreakVal>();
+void Interpreter::endTask() {
+  if (tasks.top().ownsScope) {
+    frames.pop();
+  }
+  tasks.pop();
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalBlockStmt(const AstNodes::BlockStmt* blockStmt, Environment* parent) {
-  Serial.println("evalBlockStmt");
-  Environment* env = new Environment(parent);
-  std::unique_ptr<Values::RuntimeVal> lastEvaluated;
-  for (size_t i = 0; i < blockStmt->body.size(); i++) {
-    lastEvaluated = evaluate(blockStmt->body[i].get(), env);
-    if (lastEvaluated->type == Values::ValueType::Break) break;
+bool Interpreter::evalCondition(const AstNodes::Expr* test, Environment* env, const char* errMsg) {
+  Values::Value scratch;
+  const Values::Value& result = evalBorrowed(test, env, scratch);
+  if (result.type != Values::ValueType::Boolean) {
+    ErrorHandler::restart(errMsg);
   }
-  delete env;
-  return lastEvaluated;
+  return result.boolean;
+}
+
+Values::Value Interpreter::evalVarDeclaration(const AstNodes::VarDeclaration* declaration, Environment* env) {
+  Serial.println("evalVarDeclaration");
+  Values::Value val = declaration->value ? evaluate(declaration->value.get(), env) : Values::Value::makeNull();
+  return env->declareVar(declaration->ident, std::move(val), declaration->constant);
 }
 
-std::unique_ptr<Values::BooleanVal> Interpreter::evalLogicalExpr(const AstNodes::LogicalExpr* logicalExpr, Environment* env) {
+Values::Value Interpreter::evalFunctionDeclaration(const AstNodes::FunctionDeclaration* declaration, Environment* env) {
+  Serial.println("evalFunctionDeclaration");
+  return env->declareVar(declaration->name, Values::Value::makeFunction(declaration), true);
+}
+
+Values::Value Interpreter::evalLogicalExpr(const AstNodes::LogicalExpr* logicalExpr, Environment* env) {
   Serial.println("evalLogicalExpr");
-  std::unique_ptr<Values::RuntimeVal> left = evaluate(logicalExpr->left.get(), env);
-  std::unique_ptr<Values::RuntimeVal> right = evaluate(logicalExpr->right.get(), env);
+  // the left value is used up before the right one is evaluated, so it can always be borrowed
+  Values::Value scratch;
+  const Values::Value& left = evalBorrowed(logicalExpr->left.get(), env, scratch);
+
+  if (left.type != Values::ValueType::Boolean) {
+    ErrorHandler::restart("Cannot use \"", logicalExpr->op, "\" on non-boolean values");
+  }
 
-  Serial.println("Evaluated left and right part of logical expression");
+  // the right side is only evaluated if it can still change the result
+  bool isAnd = strcmp(logicalExpr->op, "and") == 0;
+  if (left.boolean != isAnd) {
+    Serial.println("Short-circuited logical expression");
+    return Values::Value::makeBoolean(left.boolean);
+  }
+
+  const Values::Value& right = evalBorrowed(logicalExpr->right.get(), env, scratch);
 
-  if (left->type != Values::ValueType::Boolean || right->type != Values::ValueType::Boolean) {
+  if (right.type != Values::ValueType::Boolean) {
     ErrorHandler::restart("Cannot use \"", logicalExpr->op, "\" on non-boolean values");
-    return std::make_unique<Values::BooleanVal>(false);
-  } else {
-    const Values::BooleanVal* leftBool = static_cast<const Values::BooleanVal*>(left.get());
-    const Values::BooleanVal* rightBool = static_cast<const Values::BooleanVal*>(right.get());
+  }
 
-    Serial.println("Both boolean vals");
+  Serial.print("Result: ");
+  Serial.println(right.boolean ? "true" : "false");
 
-    std::unique_ptr<Values::BooleanVal> result = std::make_unique<Values::BooleanVal>();
+  return Values::Value::makeBoolean(right.boolean);
+}
 
-    if (strcmp(logicalExpr->op, "and") == 0) {
-      result->value = leftBool->value && rightBool->value;
-    } else if (strcmp(logicalExpr->op, "or") == 0) {
-      result->value = leftBool->value || rightBool->value;
+Values::Value Interpreter::evalBinaryExpr(const AstNodes::BinaryExpr* binExp, Environment* env) {
+  Serial.println("evalBinaryExpr");
+  if (binExp->specialization == AstNodes::Specialization::Int) {
+    // numbers are copied out right away, so no operand has to be borrowed or checked for side effects
+    Values::Value left = evalOperand(binExp->left.get(), env);
+    Values::Value right = evalOperand(binExp->right.get(), env);
+    if (left.type == Values::ValueType::Number && right.type == Values::ValueType::Number) {
+      return evalIntBinaryExpr(left.number, right.number, binExp->opcode);
     }
+    deoptimize(binExp->specialization);
+    return evalBinaryOperands(binExp, left, right, env);
+  }
 
-    Serial.print("Result: ");
-    Serial.println(result->value ? "true" : "false");
+  // the left value may only be borrowed if evaluating the right one cannot reassign it
+  Values::Value leftScratch, rightScratch;
+  const Values::Value& left = isSideEffectFree(binExp->right.get()) ? evalBorrowed(binExp->left.get(), env, leftScratch) : (leftScratch = evaluate(binExp->left.get(), env));
+  const Values::Value& right = evalBorrowed(binExp->right.get(), env, rightScratch);
 
-    return result;
+  if (binExp->specialization == AstNodes::Specialization::Unquickened) {
+    bool ints = left.type == Values::ValueType::Number && right.type == Values::ValueType::Number;
+    binExp->specialization = ints ? AstNodes::Specialization::Int : AstNodes::Specialization::Generic;
   }
+  return evalBinaryOperands(binExp, left, right, env);
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalBinaryExpr(const AstNodes::BinaryExpr* binExp, Environment* env) {
-  Serial.println("evalBinaryExpr");
-  std::unique_ptr<Values::RuntimeVal> left = evaluate(binExp->left.get(), env);
-  std::unique_ptr<Values::RuntimeVal> right = evaluate(binExp->right.get(), env);
+Values::Value Interpreter::evalBinaryOperands(const AstNodes::BinaryExpr* binExp, const Values::Value& left, const Values::Value& right, Environment* env) {
+  if (left.type == Values::ValueType::Number && right.type == Values::ValueType::Number) {
+    return evalIntBinaryExpr(left.number, right.number, binExp->opcode);
+  } else if (left.isNumeric() && right.isNumeric()) {
+    return evalFixedBinaryExpr(left, right, binExp->opcode);
+  } else if (left.type == Values::ValueType::Boolean && right.type == Values::ValueType::Boolean) {
+    return evalBooleanBinaryExpr(left, right, binExp->opcode);
+  } else if (left.type == Values::ValueType::String && right.type == Values::ValueType::String) {
+    return evalStringBinaryExpr(left, right, binExp->opcode);
+  } else {
+    ErrorHandler::noComparisonPossible(Values::getString(left.type).c_str(), Values::getString(right.type).c_str());
+  }
+
+  return Values::Value::makeNull();
+}
+
+Values::Value Interpreter::evalOperand(const AstNodes::Expr* expr, Environment* env) {
+  switch (expr->kind) {
+    case AstNodes::NodeType::Identifier:
+      return resolveIdentifier(static_cast<const AstNodes::Identifier*>(expr), env).value;
+    case AstNodes::NodeType::NumericLiteral:
+      {
+        const AstNodes::NumericLiteral* numLit = static_cast<const AstNodes::NumericLiteral*>(expr);
+        return numLit->fixed ? Values::Value::makeFixed(numLit->num) : Values::Value::makeNumber(numLit->num);
+      }
+    default:
+      return evaluate(expr, env);
+  }
+}
 
-  if (left->type == Values::ValueType::Number && right->type == Values::ValueType::Number) {
-    const Values::NumberVal* leftNum = static_cast<const Values::NumberVal*>(left.get());
-    const Values::NumberVal* rightNum = static_cast<const Values::NumberVal*>(right.get());
+const Values::Value& Interpreter::evalBorrowed(const AstNodes::Stmt* expr, Environment* env, Values::Value& scratch) {
+  if (expr->kind == AstNodes::NodeType::Identifier) {
+    return resolveIdentifier(static_cast<const AstNodes::Identifier*>(expr), env).value;
+  }
 
-    return evalNumericBinaryExpr(leftNum, rightNum, binExp->op, env);
-  } else if (left->type == Values::ValueType::Boolean && right->type == Values::ValueType::Boolean) {
-    const Values::BooleanVal* leftBool = static_cast<const Values::BooleanVal*>(left.get());
-    const Values::BooleanVal* rightBool = static_cast<const Values::BooleanVal*>(right.get());
+  if (expr->kind == AstNodes::NodeType::StringLiteral) {
+    const AstNodes::StringLiteral* literal = static_cast<const AstNodes::StringLiteral*>(expr);
+    if (literal->constant < constants.size()) {
+      return constants.at(literal->constant);
+    }
+  }
 
-    return evalBooleanBinaryExpr(leftBool, rightBool, binExp->op, env);
-  } else if (left->type == Values::ValueType::String && right->type == Values::ValueType::String) {
-    const Values::StringVal* leftString = static_cast<const Values::StringVal*>(left.get());
-    const Values::StringVal* rightString = static_cast<const Values::StringVal*>(right.get());
+  scratch = evaluate(expr, env);
+  return scratch;
+}
 
-    return evalStringBinaryExpr(leftString, rightString, binExp->op, env);
-  } else {
-    ErrorHandler::noComparisonPossible(Values::getString(left->type).c_str(), Values::getString(right->type).c_str());
+Values::Value Interpreter::evalStringLiteral(const AstNodes::StringLiteral* literal) {
+  // only a literal evaluated on its own, outside of any program, is not in the table
+  if (literal->constant < constants.size()) {
+    return constants.at(literal->constant);
   }
+  return Values::Value::makeString(literal->value);
+}
 
-  return std::make_unique<Values::NullVal>();
+bool Interpreter::isSideEffectFree(const AstNodes::Stmt* expr) {
+  switch (expr->kind) {
+    case AstNodes::NodeType::Identifier:
+    case AstNodes::NodeType::NumericLiteral:
+    case AstNodes::NodeType::StringLiteral:
+      return true;
+    default:
+      return false;
+  }
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalIdentifier(const AstNodes::Identifier* ident, Environment* env) {
+Values::Value Interpreter::evalIdentifier(const AstNodes::Identifier* ident, Environment* env) {
   Serial.println("evalIdentifier");
-  std::unique_ptr<Values::RuntimeVal> val = env->lookupVar(ident->symbol);
-  return val;
+  return resolveIdentifier(ident, env).value;
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalNumericBinaryExpr(const Values::NumberVal* left, const Values::NumberVal* right, char* op, Environment* env) {
-  Serial.println("evalNumericBinaryExpr");
-  std::unique_ptr<Values::NumberVal> numberVal = std::make_unique<Values::NumberVal>();
+Bindings::Binding& Interpreter::resolveIdentifier(const AstNodes::Identifier* ident, Environment* env) {
+  if (ident->cachedDepth != AstNodes::Identifier::uncached && ident->cachedShadows == env->shadowCount) {
+    Bindings::Binding* binding = env->bindingAt(ident->cachedDepth, ident->cachedSlot, ident->symbol);
+    if (binding != nullptr) {
+      Profiler::count(Profiler::Counter::IdentifierCacheHit);
+      return *binding;
+    }
+  }
 
-  Serial.print("Left value: ");
-  Serial.println(left->value);
+  Profiler::count(Profiler::Counter::IdentifierCacheMiss);
+  ident->cachedShadows = env->shadowCount;
+  return env->resolveBinding(ident->symbol, ident->cachedDepth, ident->cachedSlot);
+}
 
-  Serial.print("Right value: ");
-  Serial.println(right->value);
+Values::Value Interpreter::evalIntBinaryExpr(int left, int right, AstNodes::BinaryOp opcode) {
+  switch (opcode) {
+    case AstNodes::BinaryOp::Add:
+      return Values::Value::makeNumber(left + right);
+    case AstNodes::BinaryOp::Subtract:
+      return Values::Value::makeNumber(left - right);
+    case AstNodes::BinaryOp::Multiply:
+      return Values::Value::makeNumber(left * right);
+    case AstNodes::BinaryOp::Divide:
+    case AstNodes::BinaryOp::Modulo:
+      if (right == 0) {
+        ErrorHandler::restart("Attempted to divide by 0");
+      }
+      return Values::Value::makeNumber(opcode == AstNodes::BinaryOp::Divide ? left / right : left % right);
+    case AstNodes::BinaryOp::Less:
+      return Values::Value::makeBoolean(left < right);
+    case AstNodes::BinaryOp::LessEqual:
+      return Values::Value::makeBoolean(left <= right);
+    case AstNodes::BinaryOp::Greater:
+      return Values::Value::makeBoolean(left > right);
+    case AstNodes::BinaryOp::GreaterEqual:
+      return Values::Value::makeBoolean(left >= right);
+    case AstNodes::BinaryOp::Equal:
+      return Values::Value::makeBoolean(left == right);
+    case AstNodes::BinaryOp::NotEqual:
+      return Values::Value::makeBoolean(left != right);
+  }
+  return Values::Value::makeNull();
+}
 
-  switch (op[0]) {
-    case '+':
-      numberVal->value = left->value + right->value;
-      break;
-    case '-':
-      numberVal->value = left->value - right->value;
-      break;
-    case '*':
-      numberVal->value = left->value * right->value;
-      break;
-    case '/':
-      if (right->value == 0) {
+void Interpreter::deoptimize(AstNodes::Specialization& specialization) {
+  specialization = AstNodes::Specialization::Generic;
+  Profiler::count(Profiler::Counter::Deoptimization);
+}
+
+Values::Value Interpreter::evalFixedBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode) {
+  Serial.println("evalFixedBinaryExpr");
+  // integers are widened instead of promoted, so they only have to fit when the result is stored
+  int64_t wideLeft = left.asWideFixed();
+  int64_t wideRight = right.asWideFixed();
+
+  switch (opcode) {
+    case AstNodes::BinaryOp::Add:
+      return Values::Value::makeFixed(Fixed::checked(wideLeft + wideRight));
+    case AstNodes::BinaryOp::Subtract:
+      return Values::Value::makeFixed(Fixed::checked(wideLeft - wideRight));
+    case AstNodes::BinaryOp::Multiply:
+      // an integer scales the raw value of the other operand
+      if (left.type == Values::ValueType::Number) {
+        return Values::Value::makeFixed(Fixed::checked((int64_t)left.number * right.fixed));
+      } else if (right.type == Values::ValueType::Number) {
+        return Values::Value::makeFixed(Fixed::checked((int64_t)right.number * left.fixed));
+      }
+      return Values::Value::makeFixed(Fixed::mul(left.fixed, right.fixed));
+    case AstNodes::BinaryOp::Divide:
+    case AstNodes::BinaryOp::Modulo:
+      if (wideRight == 0) {
         ErrorHandler::restart("Attempted to divide by 0");
-      } else {
-        numberVal->value = left->value / right->value;
       }
-      break;
-    case '%':
-      numberVal->value = (float)((int)left->value % (int)right->value);
-      break;
+      if (opcode == AstNodes::BinaryOp::Modulo) {
+        return Values::Value::makeFixed(Fixed::checked(wideLeft % wideRight));
+      } else if (right.type == Values::ValueType::Number) {
+        return Values::Value::makeFixed(Fixed::checked(left.fixed / (int64_t)right.number));
+      }
+      return Values::Value::makeFixed(Fixed::checked(wideLeft * Fixed::one / right.fixed));
+    case AstNodes::BinaryOp::Less:
+      return Values::Value::makeBoolean(wideLeft < wideRight);
+    case AstNodes::BinaryOp::LessEqual:
+      return Values::Value::makeBoolean(wideLeft <= wideRight);
+    case AstNodes::BinaryOp::Greater:
+      return Values::Value::makeBoolean(wideLeft > wideRight);
+    case AstNodes::BinaryOp::GreaterEqual:
+      return Values::Value::makeBoolean(wideLeft >= wideRight);
+    case AstNodes::BinaryOp::Equal:
+      return Values::Value::makeBoolean(wideLeft == wideRight);
+    case AstNodes::BinaryOp::NotEqual:
+      return Values::Value::makeBoolean(wideLeft != wideRight);
+  }
+  return Values::Value::makeNull();
+}
+
+Values::Value Interpreter::evalBooleanBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode) {
+  Serial.println("evalBooleanBinaryExpr");
+  switch (opcode) {
+    case AstNodes::BinaryOp::Equal:
+      return Values::Value::makeBoolean(left.boolean == right.boolean);
+    case AstNodes::BinaryOp::NotEqual:
+      return Values::Value::makeBoolean(left.boolean != right.boolean);
+    default:
+      ErrorHandler::restart("Cannot compare two Booleans with \"", AstNodes::BinaryExpr::symbol(opcode), "\"");
+      return Values::Value::makeNull();
+  }
+}
+
+Values::Value Interpreter::evalStringBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode) {
+  Serial.println("evalStringBinaryExpr");
+  // strings of different length are never equal, no need to flatten them
+  switch (opcode) {
+    case AstNodes::BinaryOp::Add:
+      return Values::Value::concat(left, right);
+    case AstNodes::BinaryOp::Equal:
+      return Values::Value::makeBoolean(left.length() == right.length() && strcmp(left.cstr(), right.cstr()) == 0);
+    case AstNodes::BinaryOp::NotEqual:
+      return Values::Value::makeBoolean(left.length() != right.length() || strcmp(left.cstr(), right.cstr()) != 0);
     default:
+      ErrorHandler::restart("Cannot compare two Strings with \"", AstNodes::BinaryExpr::symbol(opcode), "\"");
+      return Values::Value::makeNull();
+  }
+}
+
+Values::Value Interpreter::evalAssignmentExpr(const AstNodes::AssignmentExpr* assignmentExpr, Environment* env) {
+  Serial.println("evalAssignmentExpr");
+  switch (assignmentExpr->assignee->kind) {
+    case AstNodes::NodeType::Identifier:
+      {
+        Values::Value value = evaluate(assignmentExpr->value.get(), env);
+        Values::Value& target = evalLValue(assignmentExpr->assignee.get(), env);
+        target = std::move(value);
+        return target;
+      }
+    case AstNodes::NodeType::MemberExpr:
       {
-        std::unique_ptr<Values::BooleanVal> boolVal = std::make_unique<Values::BooleanVal>();
-        if (strcmp(op, "<") == 0) {
-          boolVal->value = left->value < right->value;
-        } else if (strcmp(op, "<=") == 0) {
-          boolVal->value = left->value <= right->value;
-        } else if (strcmp(op, ">") == 0) {
-          boolVal->value = left->value > right->value;
-        } else if (strcmp(op, ">=") == 0) {
-          boolVal->value = left->value >= right->value;
-        } else if (strcmp(op, "==") == 0) {
-          boolVal->value = left->value == right->value;
-        } else if (strcmp(op, "!=") == 0) {
-          boolVal->value = left->value != right->value;
-        } else {
-          ErrorHandler::restart("Unknown operator \"", op, "\" encountered while interpreting");
+        // evaluated before the target is resolved, so no evaluation can invalidate the resolved reference
+        Values::Value value = evaluate(assignmentExpr->value.get(), env);
+        MemberTarget target = evalMemberTarget(static_cast<const AstNodes::MemberExpr*>(assignmentExpr->assignee.get()), env);
+
+        if (target.array != nullptr) {
+          // written through set(), so a packed array stays packed if the value fits
+          target.array->set(target.index, std::move(value));
+          return target.array->get(target.index);
         }
-        return boolVal;
+        *target.slot = std::move(value);
+        return *target.slot;
       }
-      break;
+    default:
+      ErrorHandler::restart("Expected identifier or member expression on left side of assignment expression");
+      return Values::Value::makeNull();
+  }
+}
+
+Values::Value Interpreter::evalUpdateExpr(const AstNodes::UpdateExpr* updateExpr, Environment* env) {
+  Serial.println("evalUpdateExpr");
+  // evaluated before the target is resolved, for the same reason as the value of an assignment
+  Values::Value operand = updateExpr->value ? evaluate(updateExpr->value.get(), env) : Values::Value::makeNumber(1);
+  // x++ and x-- evaluate to the value before the update
+  bool postfix = updateExpr->value == nullptr;
+
+  if (updateExpr->target->kind == AstNodes::NodeType::MemberExpr) {
+    MemberTarget target = evalMemberTarget(static_cast<const AstNodes::MemberExpr*>(updateExpr->target.get()), env);
+
+    if (target.array != nullptr) {
+      // read and written back through set(), so a packed array stays packed if the result fits
+      Values::Value element = target.array->get(target.index);
+      Values::Value old = postfix ? element : Values::Value();
+      applyUpdate(element, operand, updateExpr->op);
+      target.array->set(target.index, Values::Value(element));
+      return postfix ? old : element;
+    }
+    Values::Value old = postfix ? *target.slot : Values::Value();
+    applyUpdate(*target.slot, operand, updateExpr->op);
+    return postfix ? old : *target.slot;
   }
 
-  return numberVal;
+  Values::Value& target = evalLValue(updateExpr->target.get(), env);
+  Values::Value old = postfix ? target : Values::Value();
+  applyUpdate(target, operand, updateExpr->op);
+  return postfix ? old : target;
 }
 
-std::unique_ptr<Values::BooleanVal> Interpreter::evalBooleanBinaryExpr(const Values::BooleanVal* left, const Values::BooleanVal* right, char* op, Environment* env) {
-  Serial.println("evalBooleanBinaryExpr");
-  std::unique_ptr<Values::BooleanVal> boolVal = std::make_unique<Values::BooleanVal>();
+void Interpreter::applyUpdate(Values::Value& target, const Values::Value& operand, AstNodes::BinaryOp op) {
+  if (target.type == Values::ValueType::Number && operand.type == Values::ValueType::Number) {
+    target.number = op == AstNodes::BinaryOp::Add ? target.number + operand.number : target.number - operand.number;
+    return;
+  }
 
-  if (strcmp(op, "==") == 0) {
-    boolVal->value = left->value == right->value;
-  } else if (strcmp(op, "!=") == 0) {
-    boolVal->value = left->value != right->value;
+  if (target.isNumeric() && operand.isNumeric()) {
+    target = evalFixedBinaryExpr(target, operand, op);
+  } else if (op == AstNodes::BinaryOp::Add && target.type == Values::ValueType::String && operand.type == Values::ValueType::String) {
+    target = evalStringBinaryExpr(target, operand, op);
   } else {
-    ErrorHandler::restart("Cannot compare two Booleans with \"", op, "\"");
+    ErrorHandler::noComparisonPossible(Values::getString(target.type).c_str(), Values::getString(operand.type).c_str());
   }
-
-  return boolVal;
 }
 
-std::unique_ptr<Values::BooleanVal> Interpreter::evalStringBinaryExpr(const Values::StringVal* left, const Values::StringVal* right, char* op, Environment* env) {
-  Serial.println("evalStringBinaryExpr");
-  std::unique_ptr<Values::BooleanVal> boolVal = std::make_unique<Values::BooleanVal>();
+Values::Value& Interpreter::evalLValue(const AstNodes::Expr* target, Environment* env) {
+  Serial.println("evalLValue");
+  if (target->kind == AstNodes::NodeType::Identifier) {
+    Bindings::Binding& binding = resolveIdentifier(static_cast<const AstNodes::Identifier*>(target), env);
+    if (binding.isConst()) {
+      ErrorHandler::restart("Trying to reassign const variable");
+    }
+    return binding.value;
+  }
 
-  if (strcmp(op, "==") == 0) {
-    boolVal->value = strcmp(left->str, right->str) == 0;
-  } else if (strcmp(op, "!=") == 0) {
-    boolVal->value = strcmp(left->str, right->str) != 0;
-  } else {
-    ErrorHandler::restart("Cannot compare two Strings with \"", op, "\"");
+  if (target->kind != AstNodes::NodeType::MemberExpr) {
+    ErrorHandler::restart("Expected identifier or member expression on left side of assignment expression");
   }
 
-  return boolVal;
+  MemberTarget member = evalMemberTarget(static_cast<const AstNodes::MemberExpr*>(target), env);
+  return member.array != nullptr ? member.array->elementRef(member.index) : *member.slot;
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalAssignmentExpr(const AstNodes::AssignmentExpr* assignmentExpr, Environment* env) {
-  Serial.println("evalAssignmentExpr");
-  switch (assignmentExpr->assignee->kind) {
-    {
-      case AstNodes::NodeType::Identifier:
-        {
-          const char* varname = static_cast<const AstNodes::Identifier*>(assignmentExpr->assignee.get())->symbol;
-          return env->assignVar(varname, evaluate(assignmentExpr->value.get(), env));
-        }
-      case AstNodes::NodeType::MemberExpr:
-        {
-          const AstNodes::MemberExpr* member = static_cast<const AstNodes::MemberExpr*>(assignmentExpr->assignee.get());
-          const char* varname = static_cast<const AstNodes::Identifier*>(member->object.get())->symbol;
-          std::unique_ptr<Values::RuntimeVal> memberVal = evaluate(member->object.get(), env);
-          std::unique_ptr<Values::RuntimeVal> propertyVal = evaluate(member->property.get(), env);
-
-          switch (memberVal->type) {
-            case Values::ValueType::ArrayVal:
-              {
-                Values::ArrayVal* array = static_cast<Values::ArrayVal*>(memberVal.get());
-                if (!member->computed) {
-                  ErrorHandler::restart("Cannot perform member access with '.' on array value");
-                }
-
-                if (propertyVal->type != Values::ValueType::Number) {
-                  ErrorHandler::restart("Computed property must evaluate to a number");
-                }
-
-                int index = static_cast<Values::NumberVal*>(propertyVal.get())->value;
-
-                if (index < 0 || index >= (int)array->elements.size()) {
-                  ErrorHandler::restart("Array index out of bounds");
-                }
-
-                array->elements[index] = evaluate(assignmentExpr->value.get(), env);
-                env->assignVar(varname, std::move(array->clone()));
-                return array->elements[index]->clone();
-              }
-            case Values::ValueType::ObjectVal:
-              {
-                Values::ObjectVal* obj = static_cast<Values::ObjectVal*>(memberVal.get());
-
-                String propertyName;
-                if (member->computed) {
-                  if (propertyVal->type != Values::ValueType::String) {
-                    ErrorHandler::restart("Computed object property must evaluate to a string");
-                  }
-
-                  propertyName = static_cast<Values::StringVal*>(propertyVal.get())->str;
-                } else {
-                  const AstNodes::Identifier* identifier = static_cast<const AstNodes::Identifier*>(member->property.get());
-                  propertyName = identifier->symbol;
-                }
-
-                if (obj->properties.find(propertyName) == obj->properties.end()) {
-                  char errMsg[100];
-                  snprintf(errMsg, sizeof(errMsg), "Cannot resolve object property name \"%s\"", propertyName.c_str());
-                  ErrorHandler::restart(errMsg);
-                }
-
-                obj->properties[propertyName] = evaluate(assignmentExpr->value.get(), env);
-                env->assignVar(varname, std::move(obj->clone()));
-                return obj->properties[propertyName]->clone();
-              }
-            default:
-              ErrorHandler::restart("Compiler Error (should not happen) Found assignment expression with member access on non-object/non-array value");
-              break;
-          }
-        }
-      default:
-        ErrorHandler::restart("Expected identifier or member expression on left side of assignment expression");
-        return nullptr;
-    }
+Interpreter::MemberTarget Interpreter::evalMemberTarget(const AstNodes::MemberExpr* member, Environment* env) {
+  // the property is evaluated before the object is resolved, for the same reason as the assigned value
+  Values::Value propertyVal;
+  if (member->computed) {
+    propertyVal = evaluate(member->property.get(), env);
+  }
+
+  Values::Value& memberVal = evalLValue(member->object.get(), env);
+
+  switch (memberVal.type) {
+    case Values::ValueType::ArrayVal:
+      {
+        size_t index = resolveArrayIndex(member, memberVal.array, propertyVal);
+        return { memberVal.mutableArray(), index, nullptr };
+      }
+    case Values::ValueType::ObjectVal:
+      {
+        uint8_t slot = resolvePropertySlot(member, memberVal.object, propertyVal);
+        return { nullptr, 0, &memberVal.mutableObject()->slots[slot] };
+      }
+    default:
+      ErrorHandler::restart("Cannot perform member access on non-object/non-array value");
+      return { nullptr, 0, &memberVal };
   }
 }
 
-std::unique_ptr<Values::ObjectVal> Interpreter::evalObjectExpr(const AstNodes::ObjectLiteral* obj, Environment* env) {
+Values::Value Interpreter::evalObjectExpr(const AstNodes::ObjectLiteral* obj, Environment* env) {
   Serial.println("evalObjectExpr");
-  std::unique_ptr<Values::ObjectVal> object = std::make_unique<Values::ObjectVal>();
+  Values::Value object = Values::Value::makeObject(obj->shape);
 
-  for (const auto& [key, value] : obj->properties) {
-    object->properties[key] = (value == nullptr) ? std::make_unique<Values::NullVal>() : evaluate(value.get(), env);
+  for (size_t slot = 0; slot < obj->values.size(); slot++) {
+    if (obj->values[slot] != nullptr) {
+      object.object->slots[slot] = evaluate(obj->values[slot].get(), env);
+    }
   }
 
   return object;
 }
 
-std::unique_ptr<Values::ArrayVal> Interpreter::evalArrayExpr(const AstNodes::ArrayLiteral* array, Environment* env) {
+Values::Value Interpreter::evalArrayExpr(const AstNodes::ArrayLiteral* array, Environment* env) {
   Serial.println("evalArrayExpr");
-  std::unique_ptr<Values::ArrayVal> arrayVal = std::make_unique<Values::ArrayVal>();
+  // numeric literals usually fit the packed representation (a fixed-point element turns it generic), other arrays are packed once evaluated
+  bool numeric = array->elementDataType == AstNodes::NodeType::NumericLiteral;
+  Values::Value arrayVal = Values::Value::makeArray(numeric ? Values::ElementKind::Int32 : Values::ElementKind::Generic);
 
-  arrayVal->elements.reserve(array->elements.size());
+  arrayVal.array->reserve(array->elements.size());
 
   for (size_t i = 0; i < array->elements.size(); i++) {
-    arrayVal->elements.push_back(evaluate(array->elements[i].get(), env));
+    arrayVal.array->push(evaluate(array->elements[i].get(), env));
+  }
+
+  if (!numeric) {
+    arrayVal.array->pack();
   }
 
   return arrayVal;
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalCallExpr(const AstNodes::CallExpr* expr, Environment* env) {
+Values::Value Interpreter::evalCallExpr(const AstNodes::CallExpr* expr, Environment* env) {
   Serial.println("evalCallExpr");
-  std::vector<std::unique_ptr<Values::RuntimeVal>> args;
-  if (!expr->args.empty()) {
-    args.reserve(expr->args.size());
+  if (expr->args.size() > maxFunctionArgs) {
+    ErrorHandler::restart("Too many arguments in function call");
+  }
+
+  // the callee is copied, so evaluating the arguments cannot reassign it
+  // a specialized call only ever has an identifier as caller, it is resolved without evaluating an expression
+  bool specialized = expr->specialization == AstNodes::Specialization::NativeCall || expr->specialization == AstNodes::Specialization::FunctionCall;
+  Values::Value fn = specialized ? resolveIdentifier(static_cast<const AstNodes::Identifier*>(expr->caller.get()), env).value : evaluate(expr->caller.get(), env);
 
+  Serial.println("Evaluated callExpr");
+
+  switch (expr->specialization) {
+    case AstNodes::Specialization::Unquickened:
+      if (expr->caller->kind != AstNodes::NodeType::Identifier) {
+        expr->specialization = AstNodes::Specialization::Generic;
+      } else if (fn.type == Values::ValueType::Function) {
+        expr->specialization = AstNodes::Specialization::FunctionCall;
+      } else if (fn.type == Values::ValueType::NativeFn) {
+        expr->specialization = AstNodes::Specialization::NativeCall;
+      } else {
+        expr->specialization = AstNodes::Specialization::Generic;
+      }
+      break;
+    case AstNodes::Specialization::FunctionCall:
+      if (fn.type == Values::ValueType::Function) {
+        return callFunction(fn.function, expr, env);
+      }
+      deoptimize(expr->specialization);
+      break;
+    case AstNodes::Specialization::NativeCall:
+      if (fn.type == Values::ValueType::NativeFn) {
+        return callNative(fn, expr, env);
+      }
+      deoptimize(expr->specialization);
+      break;
+    default:
+      break;
+  }
+
+  if (fn.type == Values::ValueType::Function) {
+    return callFunction(fn.function, expr, env);
+  } else if (fn.type != Values::ValueType::NativeFn) {
+    ErrorHandler::restart("Cannot call value that is not a function");
+  }
+
+  return callNative(fn, expr, env);
+}
+
+Values::Value Interpreter::callNative(const Values::Value& fn, const AstNodes::CallExpr* expr, Environment* env) {
+  // arguments are passed to the native function as a span over this buffer, no heap allocation
+  Values::Value argBuffer[maxFunctionArgs];
+  if (!expr->args.empty()) {
     for (size_t i = 0; i < expr->args.size(); i++) {
       Serial.println("Found function argument ");
-      args.push_back(evaluate(expr->args[i].get(), env));
+      argBuffer[i] = evaluate(expr->args[i].get(), env);
     }
   } else {
     Serial.println("No function arguments found");
   }
 
-  std::unique_ptr<Values::RuntimeVal> fn = evaluate(expr->caller.get(), env);
+  const char* callee = expr->caller->kind == AstNodes::NodeType::Identifier ? Symbols::name(static_cast<const AstNodes::Identifier*>(expr->caller.get())->symbol) : "<anonymous>";
+  Serial.print("Found function ");
+  Serial.println(callee);
 
-  Serial.println("Evaluated callExpr");
+  Values::ArgSpan args = { argBuffer, (uint8_t)expr->args.size(), callee };
+  Values::Value result = fn.call(args, env);
+  Serial.println("Called function");
+  return result;
+}
 
-  if (fn->type != Values::ValueType::NativeFn) {
-    ErrorHandler::restart("Cannot call value that is not a function");
+Values::Value Interpreter::callFunction(const AstNodes::FunctionDeclaration* function, const AstNodes::CallExpr* expr, Environment* env) {
+  Serial.print("Calling function ");
+  Serial.println(Symbols::name(function->name));
+
+  if (expr->args.size() != function->params.size()) {
+    char errMsg[100];
+    snprintf(errMsg, sizeof(errMsg), "Function \"%s\" expects %u arguments, got %u", Symbols::name(function->name), (unsigned)function->params.size(), (unsigned)expr->args.size());
+    ErrorHandler::restart(errMsg);
+  }
+  if (callDepth >= maxCallDepth) {
+    ErrorHandler::restart("Function calls are nested too deeply");
   }
 
-  Values::NativeFnVal* function = static_cast<Values::NativeFnVal*>(fn.get());
+  // the arguments are evaluated in the caller's scope, the frame is not reachable from it
+  Environment* frame = frames.push(env->global());
+  for (size_t i = 0; i < expr->args.size(); i++) {
+    frame->declareVar(function->params[i], evaluate(expr->args[i].get(), env), false);
+  }
 
-  Serial.print("Found function ");
-  Serial.println(static_cast<const AstNodes::Identifier*>(expr->caller.get())->symbol);
+  callDepth++;
+  Profiler::peak(Profiler::Counter::CallDepth, callDepth);
+  Values::Value result;
+  Completion completion = execute(function->body.get(), frame, result);
+  callDepth--;
 
+  frames.pop();
 
-  std::unique_ptr<Values::RuntimeVal> result = function->call(args, env);
-  Serial.println("Called function");
-  return result;
+  return completion == Completion::Return ? result : Values::Value::makeNull();
 }
 
-std::unique_ptr<Values::RuntimeVal> Interpreter::evalMemberExpr(const AstNodes::MemberExpr* member, Environment* env) {
+Values::Value Interpreter::evalMemberExpr(const AstNodes::MemberExpr* member, Environment* env) {
   Serial.println("evalMemberExpr");
 
-  std::unique_ptr<Values::RuntimeVal> memberVal = evaluate(member->object.get(), env);
-
-  if (memberVal->type == Values::ValueType::ObjectVal) {
-    Values::ObjectVal* obj = static_cast<Values::ObjectVal*>(memberVal.get());
+  // the property is evaluated first, so it cannot reassign the borrowed object
+  // it is borrowed as well if evaluating the object cannot reassign it either
+  Values::Value propertyScratch;
+  const Values::Value* propertyVal = &propertyScratch;
+  if (member->computed) {
+    if (isSideEffectFree(member->object.get())) {
+      propertyVal = &evalBorrowed(member->property.get(), env, propertyScratch);
+    } else {
+      propertyScratch = evaluate(member->property.get(), env);
+    }
+  }
 
-    String propertyName;
-    if (member->computed) {
-      std::unique_ptr<Values::RuntimeVal> propertyVal = evaluate(member->property.get(), env);
+  Values::Value scratch;
+  const Values::Value& memberVal = evalBorrowed(member->object.get(), env, scratch);
 
-      if (propertyVal->type != Values::ValueType::String) {
-        ErrorHandler::restart("Computed object property must evaluate to a string");
+  if (member->specialization == AstNodes::Specialization::Unquickened) {
+    bool arrayIndex = member->computed && memberVal.type == Values::ValueType::ArrayVal && propertyVal->type == Values::ValueType::Number;
+    member->specialization = arrayIndex ? AstNodes::Specialization::ArrayIndex : AstNodes::Specialization::Generic;
+  }
+  if (member->specialization == AstNodes::Specialization::ArrayIndex) {
+    if (memberVal.type == Values::ValueType::ArrayVal && propertyVal->type == Values::ValueType::Number) {
+      int index = propertyVal->number;
+      if (index < 0 || index >= (int)memberVal.array->size()) {
+        ErrorHandler::restart("Array index out of bounds");
       }
-
-      propertyName = static_cast<Values::StringVal*>(propertyVal.get())->str;
-    } else {
-      const AstNodes::Identifier* identifier = static_cast<const AstNodes::Identifier*>(member->property.get());
-      propertyName = identifier->symbol;
+      return memberVal.array->get(index);
     }
+    deoptimize(member->specialization);
+  }
+
+  if (memberVal.type == Values::ValueType::ObjectVal) {
+    const Values::ObjectVal* obj = memberVal.object;
+    return obj->slots[resolvePropertySlot(member, obj, *propertyVal)];
+  } else if (memberVal.type == Values::ValueType::ArrayVal) {
+    return memberVal.array->get(resolveArrayIndex(member, memberVal.array, *propertyVal));
+  }
 
-    if (obj->properties.find(propertyName) == obj->properties.end()) {
-      char errMsg[100];
-      snprintf(errMsg, sizeof(errMsg), "Cannot resolve object property name \"%s\"", propertyName.c_str());
-      ErrorHandler::restart(errMsg);
+  ErrorHandler::restart("Cannot perform member access on non-object/non-array value");
+  return memberVal;
+}
+
+uint8_t Interpreter::resolvePropertySlot(const AstNodes::MemberExpr* member, const Values::ObjectVal* obj, const Values::Value& propertyVal) {
+  if (!member->computed && member->cachedShape == obj->shape) {
+    return member->cachedSlot;
+  }
+
+  const char* propertyName;
+  uint8_t slot;
+  if (member->computed) {
+    if (propertyVal.type != Values::ValueType::String) {
+      ErrorHandler::restart("Computed object property must evaluate to a string");
     }
 
-    return obj->properties[propertyName]->clone();
-  } else if (memberVal->type == Values::ValueType::ArrayVal) {
-    Values::ArrayVal* array = static_cast<Values::ArrayVal*>(memberVal.get());
+    propertyName = propertyVal.cstr();
+    slot = obj->shape->slotOf(propertyName);
+  } else {
+    uint16_t symbol = static_cast<const AstNodes::Identifier*>(member->property.get())->symbol;
+    propertyName = Symbols::name(symbol);
+    slot = obj->shape->slotOf(symbol);
+  }
 
-    if (member->computed) {
-      std::unique_ptr<Values::RuntimeVal> propertyVal = evaluate(member->property.get(), env);
+  if (slot == Shape::noSlot) {
+    char errMsg[100];
+    snprintf(errMsg, sizeof(errMsg), "Cannot resolve object property name \"%s\"", propertyName);
+    ErrorHandler::restart(errMsg);
+  }
 
-      if (propertyVal->type != Values::ValueType::Number) {
-        ErrorHandler::restart("Computed property must evaluate to a number");
-      }
+  if (!member->computed) {
+    member->cachedShape = obj->shape;
+    member->cachedSlot = slot;
+  }
 
-      int index = static_cast<Values::NumberVal*>(propertyVal.get())->value;
+  return slot;
+}
 
-      if (index < 0 || index >= (int)array->elements.size()) {
-        ErrorHandler::restart("Array index out of bounds");
-      }
+size_t Interpreter::resolveArrayIndex(const AstNodes::MemberExpr* member, const Values::ArrayVal* array, const Values::Value& propertyVal) {
+  if (!member->computed) {
+    ErrorHandler::restart("Cannot perform member access with '.' on array value");
+  }
 
-      return array->elements[index]->clone();
-    } else {
-      ErrorHandler::restart("Cannot perform member access with '.' on array value");
-    }
+  if (propertyVal.type != Values::ValueType::Number) {
+    ErrorHandler::restart("Computed property must evaluate to a number");
   }
 
-  ErrorHandler::restart("Cannot perform member access on non-object/non-array value");
-  return memberVal;
-}
\ No newline at end of file
+  int index = propertyVal.number;
+
+  if (index < 0 || index >= (int)array->size()) {
+    ErrorHandler::restart("Array index out of bounds");
+  }
+
+  return index;
+}
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <memory>
-
+#include "ConstantTable.h"
 #include "ErrorHandler.h"
 #include "Parser.h"
 #include "Values.h"
 #include "Environment.h"
+#include "FrameStack.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "TaskStack.h"
 
 /**
  * @class Interpreter
@@ -16,6 +19,9 @@
  */
 class Interpreter {
 public:
+  Interpreter()
+    : expressionDepth(0), callDepth(0) {}
+
   /**
    * @brief Evaluates an AST node and returns the resulting value in the given environment.
    * 
@@ -23,26 +29,116 @@ public:
    * @param env The environment in which the AST node is evaluated.
    * @return The runtime value resulting from the evaluation of the AST node.
    */
-  std::unique_ptr<Values::RuntimeVal> evaluate(const AstNodes::Stmt* astNode, Environment* env);
+  Values::Value evaluate(const AstNodes::Stmt* astNode, Environment* env);
 
 private:
+  FrameStack frames;        /**< The scopes of the blocks currently being evaluated */
+  TaskStack tasks;          /**< The programs, blocks and loops currently being executed */
+  ConstantTable constants;  /**< The values of the string literals of the running program */
+  uint8_t expressionDepth;  /**< The number of expressions currently being evaluated recursively */
+  uint8_t callDepth;        /**< The number of user-defined functions currently being called */
+
+  /**
+   * @brief Evaluates an expression or a variable declaration in the given environment.
+   * 
+   * @param astNode The expression to be evaluated.
+   * @param env The environment in which the expression is evaluated.
+   * @return The resulting value.
+   */
+  Values::Value evalExpr(const AstNodes::Stmt* astNode, Environment* env);
+
+  /**
+   * @brief How a statement completed, reported next to its value so leaving a loop or a call needs no special value.
+   */
+  enum class Completion : uint8_t {
+    Normal,    /**< Execution continues with the next statement */
+    Break,     /**< A break statement ends the innermost loop */
+    Continue,  /**< A continue statement starts the next iteration of the innermost loop */
+    Return     /**< A return statement ends the innermost function call */
+  };
+
+  /**
+   * @brief Executes a control flow statement without recursing for nested statements.
+   * 
+   * Nested programs, blocks and loops are pushed to `tasks` and executed one statement at a time.
+   * Every statement evaluates to the value of the last expression it executed, loops and if statements
+   * that did not execute any block evaluate to null.
+   * 
+   * @param stmt The statement to be executed.
+   * @param env The environment in which the statement is executed.
+   * @param lastEvaluated Receives the value of the statement, or the returned value.
+   * @return `Completion::Return` if a return statement ended the execution, `Completion::Normal` otherwise.
+   * @throws ErrorHandler::restart if the statements are nested deeper than `maxNestingDepth`.
+   */
+  Completion execute(const AstNodes::Stmt* stmt, Environment* env, Values::Value& lastEvaluated);
+
+  /**
+   * @brief Starts executing a statement, pushes a task for statements that contain others.
+   * 
+   * @param stmt The statement to be executed.
+   * @param env The environment in which the statement is executed.
+   * @param lastEvaluated Receives the value of expressions.
+   * @return How the statement completed, anything but `Completion::Normal` is passed to `unwind`.
+   */
+  Completion schedule(const AstNodes::Stmt* stmt, Environment* env, Values::Value& lastEvaluated);
+
+  /**
+   * @brief Ends the tasks a break, continue or return statement leaves.
+   * 
+   * @param completion How the statement completed.
+   * @param base The number of tasks before the current `execute` started, they are never ended.
+   * @return `Completion::Normal` once the innermost loop handled a break or continue, `Completion::Return` after
+   * every task of the current `execute` was ended by a return.
+   * @throws ErrorHandler::restart if a break or continue statement is not within a loop.
+   */
+  Completion unwind(Completion completion, uint8_t base);
+
   /**
-   * @brief Evaluates a program (a series of statements) in the given environment.
+   * @brief Ends the innermost task and the scope it owns.
+   */
+  void endTask();
+
+  /**
+   * @brief Evaluates the condition of an if or while statement.
    * 
-   * @param program The program to be evaluated.
-   * @param env The environment in which the program is evaluated.
-   * @return The last evaluated value from the program body.
+   * @param test The condition.
+   * @param env The environment in which the condition is evaluated.
+   * @param errMsg The error reported if the condition is not a boolean.
+   * @return The value of the condition.
    */
-  std::unique_ptr<Values::RuntimeVal> evalProgram(const AstNodes::Program* program, Environment* env);
+  bool evalCondition(const AstNodes::Expr* test, Environment* env, const char* errMsg);
 
   /**
    * @brief Evaluates a binary expression in the given environment.
    * 
+   * The first execution specializes the node to `Int` if both operands are numbers, later executions fetch
+   * both operands directly and compute the result from the decoded operator as long as they are.
+   * 
    * @param binExp The binary expression to be evaluated.
    * @param env The environment in which the expression is evaluated.
    * @return The resulting value from evaluating the binary expression.
    */
-  std::unique_ptr<Values::RuntimeVal> evalBinaryExpr(const AstNodes::BinaryExpr* binExp, Environment* env);
+  Values::Value evalBinaryExpr(const AstNodes::BinaryExpr* binExp, Environment* env);
+
+  /**
+   * @brief Computes a binary expression from its evaluated operands, dispatching on their types.
+   * 
+   * @param binExp The binary expression.
+   * @param left The left operand.
+   * @param right The right operand.
+   * @param env The environment in which the expression is evaluated.
+   * @return The resulting value.
+   */
+  Values::Value evalBinaryOperands(const AstNodes::BinaryExpr* binExp, const Values::Value& left, const Values::Value& right, Environment* env);
+
+  /**
+   * @brief Evaluates an operand of a specialized binary expression, variables and literals without a full evaluation.
+   * 
+   * @param expr The operand.
+   * @param env The environment in which the operand is evaluated.
+   * @return A copy of the value of the operand.
+   */
+  Values::Value evalOperand(const AstNodes::Expr* expr, Environment* env);
 
   /**
    * @brief Evaluates a variable declaration in the given environment.
@@ -51,52 +147,51 @@ private:
    * @param env The environment in which the declaration is evaluated.
    * @return The resulting value from declaring the variable.
    */
-  std::unique_ptr<Values::RuntimeVal> evalVarDeclaration(const AstNodes::VarDeclaration* declaration, Environment* env);
+  Values::Value evalVarDeclaration(const AstNodes::VarDeclaration* declaration, Environment* env);
 
   /**
-   * @brief Evaluates an if statement in the given environment.
+   * @brief Declares a user-defined function as a constant in the given environment.
    * 
-   * @param ifStmt The if statement to be evaluated.
-   * @param env The environment in which the if statement is evaluated.
-   * @return The result of evaluating the consequent or alternate block.
+   * @param declaration The function declaration to be evaluated.
+   * @param env The environment in which the function is declared.
+   * @return The function value.
    */
-  std::unique_ptr<Values::RuntimeVal> evalIfStmt(const AstNodes::IfStmt* ifStmt, Environment* env);
+  Values::Value evalFunctionDeclaration(const AstNodes::FunctionDeclaration* declaration, Environment* env);
 
   /**
-   * @brief Evaluates a while statement in the given environment.
+   * @brief Evaluates a logical expression in the given environment.
+   * 
+   * The right operand is only evaluated if the left one does not already decide the result.
    * 
-   * @param whileStmt The while statement to be evaluated.
-   * @param env The environment in which the while statement is evaluated.
-   * @return The result of evaluating the while loop.
+   * @param logicalExpr The logical expression to be evaluated.
+   * @param env The environment in which the logical expression is evaluated.
+   * @return The resulting boolean value from evaluating the logical expression.
    */
-  std::unique_ptr<Values::RuntimeVal> evalWhileStmt(const AstNodes::WhileStmt* whileStmt, Environment* env);
+  Values::Value evalLogicalExpr(const AstNodes::LogicalExpr* logicalExpr, Environment* env);
 
   /**
-   * @brief Evaluates a break statement in the given environment.
+   * @brief Evaluates an expression, borrowing the stored value instead of copying it if the expression is a variable
+   * or a string literal.
    * 
-   * @param breakStmt The break statement to be evaluated.
-   * @param env The environment in which the break statement is evaluated.
-   * @return A break value indicating the break action.
+   * @param expr The expression to be evaluated.
+   * @param env The environment in which the expression is evaluated.
+   * @param scratch Holds the result if the expression is not a variable.
+   * @return The borrowed variable or `scratch`, valid until the next assignment in `env`.
    */
-  std::unique_ptr<Values::BreakVal> evalBreakStmt(const AstNodes::BreakStmt* breakStmt, Environment* env);
+  const Values::Value& evalBorrowed(const AstNodes::Stmt* expr, Environment* env, Values::Value& scratch);
 
   /**
-   * @brief Evaluates a block of statements in the given environment.
+   * @brief Evaluates a string literal to the value of its constant pool entry, without allocating or copying the string.
    * 
-   * @param blockStmt The block statement to be evaluated.
-   * @param parent The environment of the parent block.
-   * @return The result of the last evaluated statement in the block.
+   * @param literal The string literal to be evaluated.
+   * @return The string value.
    */
-  std::unique_ptr<Values::RuntimeVal> evalBlockStmt(const AstNodes::BlockStmt* blockStmt, Environment* parent);
+  Values::Value evalStringLiteral(const AstNodes::StringLiteral* literal);
 
   /**
-   * @brief Evaluates a logical expression in the given environment.
-   * 
-   * @param logicalExpr The logical expression to be evaluated.
-   * @param env The environment in which the logical expression is evaluated.
-   * @return The resulting boolean value from evaluating the logical expression.
+   * @brief Checks whether evaluating an expression cannot assign any variable, so values borrowed before stay unchanged.
    */
-  std::unique_ptr<Values::BooleanVal> evalLogicalExpr(const AstNodes::LogicalExpr* logicalExpr, Environment* env);
+  static bool isSideEffectFree(const AstNodes::Stmt* expr);
 
   /**
    * @brief Evaluates an identifier (variable) in the given environment.
@@ -105,40 +200,71 @@ private:
    * @param env The environment in which the identifier is evaluated.
    * @return The value associated with the identifier in the environment.
    */
-  std::unique_ptr<Values::RuntimeVal> evalIdentifier(const AstNodes::Identifier* ident, Environment* env);
+  Values::Value evalIdentifier(const AstNodes::Identifier* ident, Environment* env);
 
   /**
-   * @brief Evaluates a numeric binary expression (e.g., addition, subtraction) in the given environment.
+   * @brief Resolves the variable an identifier refers to.
    * 
-   * @param left The left operand of the binary expression.
-   * @param right The right operand of the binary expression.
-   * @param op The operator of the binary expression.
-   * @param env The environment in which the expression is evaluated.
+   * The identifier remembers where it found its variable, the next resolution only checks that the variable
+   * is still at that position, unless a declaration in the scopes in between shadowed any variable since.
+   * 
+   * @param ident The identifier to be resolved.
+   * @param env The environment in which the identifier is resolved.
+   * @return The variable, valid until the next declaration in its environment.
+   * @throws ErrorHandler::restart if the variable cannot be resolved.
+   */
+  Bindings::Binding& resolveIdentifier(const AstNodes::Identifier* ident, Environment* env);
+
+  /**
+   * @brief Evaluates a binary expression of two numbers from its decoded operator.
+   * 
+   * @param left The left operand.
+   * @param right The right operand.
+   * @param opcode The decoded operator.
+   * @return The resulting number or boolean.
+   */
+  Values::Value evalIntBinaryExpr(int left, int right, AstNodes::BinaryOp opcode);
+
+  /**
+   * @brief Falls back to the generic version of a specialized node whose types did not match.
+   * 
+   * @param specialization The specialization of the node, set to `Generic`.
+   */
+  static void deoptimize(AstNodes::Specialization& specialization);
+
+  /**
+   * @brief Evaluates a fixed-point binary expression, used as soon as one operand is a fixed-point number.
+   * 
+   * Integer operands are not promoted to Q16.16, comparisons are exact for every integer and arithmetic only
+   * requires the result to be representable.
+   * 
+   * @param left The left operand, a Number or a Fixed.
+   * @param right The right operand, a Number or a Fixed.
+   * @param opcode The decoded operator.
    * @return The resulting value from evaluating the binary expression.
+   * @throws ErrorHandler::restart if an arithmetic result is outside of the fixed-point range.
    */
-  std::unique_ptr<Values::RuntimeVal> evalNumericBinaryExpr(const Values::NumberVal* left, const Values::NumberVal* right, char* op, Environment* env);
+  Values::Value evalFixedBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode);
 
   /**
    * @brief Evaluates a boolean binary expression (e.g., equality, inequality) in the given environment.
    * 
    * @param left The left operand of the binary expression.
    * @param right The right operand of the binary expression.
-   * @param op The operator of the binary expression.
-   * @param env The environment in which the expression is evaluated.
+   * @param opcode The decoded operator.
    * @return The resulting boolean value from evaluating the binary expression.
    */
-  std::unique_ptr<Values::BooleanVal> evalBooleanBinaryExpr(const Values::BooleanVal* left, const Values::BooleanVal* right, char* op, Environment* env);
+  Values::Value evalBooleanBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode);
 
   /**
-   * @brief Evaluates a binary expression of two strings (e.g., equality, inequality) in the given environment.
+   * @brief Evaluates a binary expression of two strings (concatenation, equality, inequality) in the given environment.
    * 
    * @param left The left operand of the binary expression.
    * @param right The right operand of the binary expression.
-   * @param op The operator of the binary expression.
-   * @param env The environment in which the expression is evaluated.
-   * @return The resulting boolean value from evaluating the binary expression.
+   * @param opcode The decoded operator.
+   * @return The concatenated string or the resulting boolean value.
    */
-  std::unique_ptr<Values::BooleanVal> evalStringBinaryExpr(const Values::StringVal* left, const Values::StringVal* right, char* op, Environment* env);
+  Values::Value evalStringBinaryExpr(const Values::Value& left, const Values::Value& right, AstNodes::BinaryOp opcode);
 
   /**
    * @brief Evaluates an assignment expression in the given environment.
@@ -147,7 +273,60 @@ private:
    * @param env The environment in which the assignment expression is evaluated.
    * @return The result of the assignment expression evaluation.
    */
-  std::unique_ptr<Values::RuntimeVal> evalAssignmentExpr(const AstNodes::AssignmentExpr* node, Environment* env);
+  Values::Value evalAssignmentExpr(const AstNodes::AssignmentExpr* node, Environment* env);
+
+  /**
+   * @brief Evaluates a compound assignment, increment or decrement in the given environment.
+   * 
+   * @param updateExpr The update expression to be evaluated.
+   * @param env The environment in which the update expression is evaluated.
+   * @return The updated value, the value before the update for `x++` and `x--`.
+   */
+  Values::Value evalUpdateExpr(const AstNodes::UpdateExpr* updateExpr, Environment* env);
+
+  /**
+   * @brief Adds an operand to or subtracts it from a stored value.
+   * 
+   * Numbers are changed in place, other values fall back to the binary expression of the operator.
+   * 
+   * @param target The stored value.
+   * @param operand The added or subtracted value.
+   * @param op `Add` or `Subtract`.
+   */
+  void applyUpdate(Values::Value& target, const Values::Value& operand, AstNodes::BinaryOp op);
+
+  /**
+   * @brief Resolves the target of an assignment to the stored value it refers to.
+   * 
+   * Identifiers resolve to the variable slot in their owning environment, member expressions
+   * resolve their object first and then the element or property inside of it, so nested targets
+   * like `a[i].x` are written in place. Shared containers on the way are copied on write.
+   * 
+   * @param target The identifier or member expression to be resolved.
+   * @param env The environment in which the target is resolved.
+   * @return A reference to the stored value, valid until the next evaluation in `env`.
+   */
+  Values::Value& evalLValue(const AstNodes::Expr* target, Environment* env);
+
+  /**
+   * @brief The element or property a member expression refers to, resolved for writing.
+   */
+  typedef struct MemberTarget {
+    Values::ArrayVal* array;  ///< The unshared array, nullptr if the target is a property.
+    size_t index;             ///< The index of the element in `array`.
+    Values::Value* slot;      ///< The stored property value, if `array` is nullptr.
+  } MemberTarget;
+
+  /**
+   * @brief Resolves the member expression on the left side of an assignment, shared containers are copied on write.
+   * 
+   * Elements are returned by index, so callers writing a whole value can keep a packed array packed.
+   * 
+   * @param member The member expression to be resolved.
+   * @param env The environment in which the member expression is resolved.
+   * @return The resolved element or property, valid until the next evaluation in `env`.
+   */
+  MemberTarget evalMemberTarget(const AstNodes::MemberExpr* member, Environment* env);
 
   /**
    * @brief Evaluates an object expression in the given environment.
@@ -156,7 +335,7 @@ private:
    * @param env The environment in which the assignment expression is evaluated.
    * @return The result of the object expression evaluation.
    */
-  std::unique_ptr<Values::ObjectVal> evalObjectExpr(const AstNodes::ObjectLiteral* obj, Environment* env);
+  Values::Value evalObjectExpr(const AstNodes::ObjectLiteral* obj, Environment* env);
 
   /**
    * @brief Evaluates an array expression in the given environment.
@@ -165,23 +344,79 @@ private:
    * @param env The environment in which the array expression is evaluated.
    * @return The result of the array expression evaluation.
    */
-  std::unique_ptr<Values::ArrayVal> evalArrayExpr(const AstNodes::ArrayLiteral* array, Environment* env);
+  Values::Value evalArrayExpr(const AstNodes::ArrayLiteral* array, Environment* env);
 
   /**
    * @brief Evaluates a function call expression in the given environment.
    * 
+   * The first execution specializes a call by name to the kind of function it called, later executions resolve
+   * the name directly and skip the dispatch as long as it stays that kind.
+   * 
    * @param expr The call expression to be evaluated.
    * @param env The environment in which the call expression is evaluated.
    * @return The result of evaluating the function call.
    */
-  std::unique_ptr<Values::RuntimeVal> evalCallExpr(const AstNodes::CallExpr* expr, Environment* env);
+  Values::Value evalCallExpr(const AstNodes::CallExpr* expr, Environment* env);
+
+  /**
+   * @brief Calls a native function with the evaluated arguments of a call expression.
+   * 
+   * @param fn The native function.
+   * @param expr The call expression.
+   * @param env The environment in which the arguments are evaluated.
+   * @return The result of the function.
+   */
+  Values::Value callNative(const Values::Value& fn, const AstNodes::CallExpr* expr, Environment* env);
+
+  /**
+   * @brief Calls a user-defined function.
+   * 
+   * The call frame is taken from `frames`, its parent is the global environment the function was declared in.
+   * Every argument is evaluated straight into the slot of its parameter, so a call allocates neither an
+   * environment nor an argument list.
+   * 
+   * @param function The declaration of the called function.
+   * @param expr The call expression.
+   * @param env The environment in which the arguments are evaluated.
+   * @return The returned value, null if the body ended without a return statement.
+   * @throws ErrorHandler::restart if the argument count does not match or calls are nested deeper than `maxCallDepth`.
+   */
+  Values::Value callFunction(const AstNodes::FunctionDeclaration* function, const AstNodes::CallExpr* expr, Environment* env);
 
   /**
    * @brief Evaluates a member expression in the given environment.
    * 
+   * The first execution specializes the node to `ArrayIndex` if it indexes an array with a number, later executions
+   * read the element directly as long as they do.
+   * 
    * @param expr The member expression to be evaluated.
    * @param env The environment in which the member expression is evaluated.
    * @return The result of evaluating the member expression.
    */
-  std::unique_ptr<Values::RuntimeVal> evalMemberExpr(const AstNodes::MemberExpr* member, Environment* env);
+  Values::Value evalMemberExpr(const AstNodes::MemberExpr* member, Environment* env);
+
+  /**
+   * @brief Resolves the slot of the accessed property in an object.
+   * 
+   * Non-computed accesses remember the shape and slot they resolved on the member expression,
+   * so repeated accesses on objects of the same shape skip the name lookup.
+   * 
+   * @param member The member expression accessing the object.
+   * @param obj The accessed object.
+   * @param propertyVal The evaluated property, only used if the member expression is computed.
+   * @return The slot of the property in `obj`.
+   * @throws ErrorHandler::restart if the object has no such property.
+   */
+  uint8_t resolvePropertySlot(const AstNodes::MemberExpr* member, const Values::ObjectVal* obj, const Values::Value& propertyVal);
+
+  /**
+   * @brief Resolves the accessed index of an array.
+   * 
+   * @param member The member expression accessing the array.
+   * @param array The accessed array.
+   * @param propertyVal The evaluated index.
+   * @return The index of the element in `array`.
+   * @throws ErrorHandler::restart if the access is not computed, the index is not a number or out of bounds.
+   */
+  size_t resolveArrayIndex(const AstNodes::MemberExpr* member, const Values::ArrayVal* array, const Values::Value& propertyVal);
 };
\ No newline at end of file
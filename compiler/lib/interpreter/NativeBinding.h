@@ -0,0 +1,292 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "Constants.h"
+#include "ErrorHandler.h"
+#include "PadsComm.h"
+#include "Values.h"
+
+class Environment;
+
+/**
+ * @brief Compile-time glue between C++ functions and the interpreter's native function values.
+ *
+ * `bindNative<&Fn>` generates a `Values::NativeFunction` that checks the argument count,
+ * converts every argument to the matching C++ parameter type and wraps the return value into a runtime value.
+ * All of this is derived from the signature of `Fn`, so registering a new builtin is a single line in the
+ * `Builtins` table.
+ *
+ * Member functions are called on `Class::getInstance()` (e.g. `PadsComm`). Parameters whose script-side meaning
+ * differs from their C++ type (e.g. an optional pad index behind a defaulted `uint8_t`) can be overridden by passing
+ * the argument types explicitly: `bindNative<&PadsComm::playWinnerJingle, OptionalPad>`.
+ */
+namespace NativeBinding {
+
+/**
+ * @brief An optional trailing pad index, defaults to all pads (`anyPad`) when omitted.
+ */
+typedef struct OptionalPad {
+  uint8_t index = anyPad;  ///< The selected pad index.
+
+  operator uint8_t() const {
+    return index;
+  }
+} OptionalPad;
+
+/**
+ * @brief An optional trailing argument of type T.
+ */
+template<typename T>
+struct Optional {
+  bool given = false;  ///< Whether the argument was passed by the script.
+  T value{};           ///< The passed argument, value-initialized if not given.
+};
+
+/**
+ * @brief Restarts with an error naming the called function and the offending argument.
+ * @param args The arguments of the call.
+ * @param index The index of the offending argument.
+ * @param expected The name of the expected value type.
+ */
+inline void wrongArgType(const Values::ArgSpan& args, uint8_t index, const char* expected) {
+  char errMsg[100];
+  snprintf(errMsg, sizeof(errMsg), "Expected %s for argument %u of '%s()'", expected, index + 1, args.callee);
+  ErrorHandler::restart(errMsg);
+}
+
+/**
+ * @brief Restarts if the number of arguments is not within the given bounds.
+ * @param args The arguments of the call.
+ * @param minArgs The number of required arguments.
+ * @param maxArgs The number of required and optional arguments.
+ */
+inline void checkArgCount(const Values::ArgSpan& args, uint8_t minArgs, uint8_t maxArgs) {
+  if (args.size < minArgs || args.size > maxArgs) {
+    char errMsg[100];
+    snprintf(errMsg, sizeof(errMsg), "'%s()' expects %u to %u arguments, got %u", args.callee, minArgs, maxArgs, args.size);
+    ErrorHandler::restart(errMsg);
+  }
+}
+
+/**
+ * @brief Reads a numeric argument, fixed-point numbers are truncated.
+ */
+inline int expectNumber(const Values::ArgSpan& args, uint8_t index) {
+  if (args[index].type == Values::ValueType::Fixed) {
+    return Fixed::toInt(args[index].fixed);
+  }
+  if (args[index].type != Values::ValueType::Number) {
+    wrongArgType(args, index, "Number");
+  }
+  return args[index].number;
+}
+
+/**
+ * @brief Reads a pad index argument, which must select one of the `padsCount` pads or all of them (`anyPad`).
+ */
+inline uint8_t expectPad(const Values::ArgSpan& args, uint8_t index) {
+  int pad = expectNumber(args, index);
+  if ((pad < 0 || pad >= padsCount) && pad != anyPad) {
+    char errMsg[100];
+    snprintf(errMsg, sizeof(errMsg), "Pad index %d for argument %u of '%s()' is out of range", pad, index + 1, args.callee);
+    ErrorHandler::restart(errMsg);
+  }
+  return (uint8_t)pad;
+}
+
+/**
+ * @brief Converts a runtime value argument to the C++ parameter type T.
+ *
+ * Every specialization states whether the argument may be omitted and provides `convert`.
+ */
+template<typename T>
+struct Arg;
+
+template<>
+struct Arg<int> {
+  static constexpr bool optional = false;
+  static int convert(const Values::ArgSpan& args, uint8_t index) {
+    return expectNumber(args, index);
+  }
+};
+
+// the bound `uint8_t` parameters are pad indices
+template<>
+struct Arg<uint8_t> {
+  static constexpr bool optional = false;
+  static uint8_t convert(const Values::ArgSpan& args, uint8_t index) {
+    return expectPad(args, index);
+  }
+};
+
+template<>
+struct Arg<unsigned long> {
+  static constexpr bool optional = false;
+  static unsigned long convert(const Values::ArgSpan& args, uint8_t index) {
+    return (unsigned long)expectNumber(args, index);
+  }
+};
+
+template<>
+struct Arg<Values::Value> {
+  static constexpr bool optional = false;
+  static const Values::Value& convert(const Values::ArgSpan& args, uint8_t index) {
+    return args[index];
+  }
+};
+
+template<>
+struct Arg<OptionalPad> {
+  static constexpr bool optional = true;
+  static OptionalPad convert(const Values::ArgSpan& args, uint8_t index) {
+    OptionalPad pad;
+    if (index < args.size) {
+      pad.index = expectPad(args, index);
+    }
+    return pad;
+  }
+};
+
+template<typename T>
+struct Arg<Optional<T>> {
+  static constexpr bool optional = true;
+  static Optional<T> convert(const Values::ArgSpan& args, uint8_t index) {
+    Optional<T> arg;
+    if (index < args.size) {
+      arg.given = true;
+      arg.value = Arg<T>::convert(args, index);
+    }
+    return arg;
+  }
+};
+
+/**
+ * @brief Wraps the C++ return value of type R into a runtime value.
+ */
+template<typename R>
+struct Result;
+
+template<>
+struct Result<void> {
+  static Values::Value wrap() {
+    return Values::Value::makeNull();
+  }
+};
+
+template<>
+struct Result<bool> {
+  static Values::Value wrap(bool value) {
+    return Values::Value::makeBoolean(value);
+  }
+};
+
+template<>
+struct Result<int> {
+  static Values::Value wrap(int value) {
+    return Values::Value::makeNumber(value);
+  }
+};
+
+/**
+ * @brief Pad operations report success to the script, how they finished is handled by `PadsComm` itself.
+ */
+template<>
+struct Result<PadsComm::WaitResult> {
+  static Values::Value wrap(PadsComm::WaitResult) {
+    return Values::Value::makeBoolean(true);
+  }
+};
+
+/**
+ * @brief A pad index if a pad was occupied, -1 if the wait was cancelled or timed out.
+ */
+template<>
+struct Result<std::variant<int, PadsComm::WaitResult>> {
+  static Values::Value wrap(const std::variant<int, PadsComm::WaitResult>& value) {
+    return Values::Value::makeNumber(std::holds_alternative<int>(value) ? std::get<int>(value) : -1);
+  }
+};
+
+/**
+ * @brief Decomposes a function pointer type into its return type and decayed parameter types.
+ */
+template<typename F>
+struct Signature;
+
+template<typename R, typename... P>
+struct Signature<R (*)(P...)> {
+  using Return = R;
+  using Params = std::tuple<std::remove_cv_t<std::remove_reference_t<P>>...>;
+
+  template<auto Fn, typename... A>
+  static R invoke(A&&... args) {
+    return Fn(std::forward<A>(args)...);
+  }
+};
+
+template<typename R, typename C, typename... P>
+struct Signature<R (C::*)(P...)> {
+  using Return = R;
+  using Params = std::tuple<std::remove_cv_t<std::remove_reference_t<P>>...>;
+
+  template<auto Fn, typename... A>
+  static R invoke(A&&... args) {
+    return (C::getInstance()->*Fn)(std::forward<A>(args)...);
+  }
+};
+
+template<typename R, typename C, typename... P>
+struct Signature<R (C::*)(P...) const> {
+  using Return = R;
+  using Params = std::tuple<std::remove_cv_t<std::remove_reference_t<P>>...>;
+
+  template<auto Fn, typename... A>
+  static R invoke(A&&... args) {
+    return (C::getInstance()->*Fn)(std::forward<A>(args)...);
+  }
+};
+
+/**
+ * @brief Checks the argument count, converts all arguments and calls `Fn`.
+ *
+ * Optional arguments are expected to be trailing.
+ */
+template<auto Fn, typename Params, size_t... I>
+Values::Value call(const Values::ArgSpan& args, std::index_sequence<I...>) {
+  using Sig = Signature<decltype(Fn)>;
+  constexpr uint8_t maxArgs = sizeof...(I);
+  constexpr uint8_t minArgs = (0 + ... + (Arg<std::tuple_element_t<I, Params>>::optional ? 0 : 1));
+  static_assert(maxArgs <= maxFunctionArgs, "Native function takes more arguments than a call can pass");
+
+  checkArgCount(args, minArgs, maxArgs);
+
+  if constexpr (std::is_void_v<typename Sig::Return>) {
+    Sig::template invoke<Fn>(Arg<std::tuple_element_t<I, Params>>::convert(args, I)...);
+    return Result<void>::wrap();
+  } else {
+    return Result<typename Sig::Return>::wrap(Sig::template invoke<Fn>(Arg<std::tuple_element_t<I, Params>>::convert(args, I)...));
+  }
+}
+
+/**
+ * @brief Generates a native function for `Fn`.
+ * @tparam Fn The bound function, either a free/static function or a member function of a singleton.
+ * @tparam ArgTypes Optional script-side argument types, replacing the parameter types deduced from `Fn`.
+ * @param args The evaluated arguments of the call.
+ * @param env The environment of the call.
+ * @return The wrapped return value of `Fn`.
+ */
+template<auto Fn, typename... ArgTypes>
+Values::Value bindNative(const Values::ArgSpan& args, Environment* env) {
+  using Deduced = typename Signature<decltype(Fn)>::Params;
+  using Bound = std::conditional_t<sizeof...(ArgTypes) == 0, Deduced, std::tuple<ArgTypes...>>;
+  static_assert(std::tuple_size_v<Bound> == std::tuple_size_v<Deduced>, "Explicit argument types must match the parameter count of the bound function");
+
+  return call<Fn, Bound>(args, std::make_index_sequence<std::tuple_size_v<Bound>>{});
+}
+
+}  // namespace NativeBinding
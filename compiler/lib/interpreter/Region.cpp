@@ -0,0 +1,104 @@
+#include "Region.h"
+
+#include <new>
+
+char* Region::begin = nullptr;
+char* Region::top = nullptr;
+char* Region::end = nullptr;
+Region::FreeBlock* Region::freeLists[regionSizeClasses] = {};
+size_t Region::liveBlocks = 0;
+
+void Region::open(size_t bytes) {
+  if (isOpen()) {
+    ErrorHandler::reportWarning("Region is already open");
+    return;
+  }
+
+  begin = static_cast<char*>(::operator new(bytes, std::nothrow));
+  if (begin == nullptr) {
+    ErrorHandler::reportWarning("Not enough memory for the region, allocating from the heap");
+    return;
+  }
+
+  top = begin;
+  end = begin + bytes;
+  liveBlocks = 0;
+}
+
+void Region::close() {
+  if (!isOpen()) {
+    return;
+  }
+
+  // a block freed after closing would be handed to the heap, which never allocated it
+  if (liveBlocks != 0) {
+    ErrorHandler::restart("Region closed while blocks are still in use");
+  }
+
+  ::operator delete(begin);
+  begin = top = end = nullptr;
+  memset(freeLists, 0, sizeof(freeLists));
+}
+
+void* Region::allocate(size_t size) {
+  size_t sc = sizeClass(size);
+  if (!isOpen() || sc >= regionSizeClasses) {
+    return ::operator new(size);
+  }
+
+  FreeBlock* block = freeLists[sc];
+  if (block != nullptr) {
+    freeLists[sc] = block->next;
+    liveBlocks++;
+    return block;
+  }
+
+  size_t blockSize = (sc + 1) * granularity;
+  if ((size_t)(end - top) < blockSize) {
+    return ::operator new(size);
+  }
+
+  void* ptr = top;
+  top += blockSize;
+  liveBlocks++;
+  return ptr;
+}
+
+void* Region::allocateBuffer(size_t size) {
+  size_t blockSize = (size + granularity - 1) / granularity * granularity;
+  if (!isOpen() || (size_t)(end - top) < blockSize) {
+    return ::operator new(size);
+  }
+
+  void* ptr = top;
+  top += blockSize;
+  liveBlocks++;
+  return ptr;
+}
+
+void Region::deallocateBuffer(void* ptr, size_t size) {
+  if (!contains(ptr)) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  // only the last buffer can be returned to the free space, others are released when the region closes
+  size_t blockSize = (size + granularity - 1) / granularity * granularity;
+  if (static_cast<char*>(ptr) + blockSize == top) {
+    top = static_cast<char*>(ptr);
+  }
+  liveBlocks--;
+}
+
+void Region::deallocate(void* ptr, size_t size) {
+  if (!contains(ptr)) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t sc = sizeClass(size);
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  block->next = freeLists[sc];
+  freeLists[sc] = block;
+  liveBlocks--;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Constants.h"
+#include "ErrorHandler.h"
+
+/**
+ * @class Region
+ * @brief A per-game memory region for everything the interpreter allocates at runtime.
+ *
+ * While a region is open, runtime values, their element buffers and environments are carved out of one
+ * contiguous block instead of going through the general heap one by one. Freed blocks are kept in free lists
+ * per size class and handed out again to allocations of the same class, so the temporaries of a running game
+ * are recycled without touching the heap. Closing the region releases the whole block at once, regardless of
+ * how it was used, so consecutive games do not fragment the heap.
+ *
+ * Allocations larger than the biggest size class, allocations once the region is full and all allocations while
+ * no region is open fall back to the heap. Long-lived buffers of any size are taken from the region with
+ * `allocateBuffer` instead.
+ */
+class Region {
+public:
+  /**
+   * @brief Opens the region, does nothing if the block cannot be allocated.
+   * @param bytes The size of the region in bytes.
+   */
+  static void open(size_t bytes);
+
+  /**
+   * @brief Releases the whole region in O(1), everything allocated from it must already be destroyed.
+   * @throws ErrorHandler::restart if blocks of the region are still in use.
+   */
+  static void close();
+
+  /**
+   * @brief Allocates a block.
+   * @param size The size of the block in bytes.
+   * @return The allocated block, aligned for any type.
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * @brief Frees a block returned by `allocate`.
+   * @param ptr The block.
+   * @param size The size the block was allocated with.
+   */
+  static void deallocate(void* ptr, size_t size);
+
+  /**
+   * @brief Allocates a buffer living for most of a game, like the stacks of the interpreter, regardless of its size.
+   *
+   * The buffer is carved from the free space of the region even if it is larger than the biggest size class,
+   * it falls back to the heap only if the region is not open or full.
+   * @param size The size of the buffer in bytes.
+   * @return The allocated buffer, aligned for any type.
+   */
+  static void* allocateBuffer(size_t size);
+
+  /**
+   * @brief Frees a buffer returned by `allocateBuffer`.
+   * @param ptr The buffer.
+   * @param size The size the buffer was allocated with.
+   */
+  static void deallocateBuffer(void* ptr, size_t size);
+
+  /**
+   * @brief Checks whether a block lies inside of the open region.
+   */
+  static bool contains(const void* ptr) {
+    return ptr >= begin && ptr < end;
+  }
+
+  /**
+   * @brief Checks whether a region is open.
+   */
+  static bool isOpen() {
+    return begin != nullptr;
+  }
+
+  /**
+   * @brief Returns the number of bytes taken from the region so far, including freed blocks.
+   */
+  static size_t usedBytes() {
+    return top - begin;
+  }
+
+  /**
+   * @brief Opens a region for the lifetime of the scope, everything using the region must be declared after it.
+   */
+  class Scope {
+  public:
+    Scope(size_t bytes = gameRegionBytes) {
+      open(bytes);
+    }
+
+    ~Scope() {
+      close();
+    }
+
+    // Delete copy constructor and copy assignment operator
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+  static const size_t granularity = alignof(std::max_align_t); /**< Alignment and size class step of blocks */
+
+private:
+  /**
+   * @brief Returns the size class of a block size, `regionSizeClasses` or more if the block is too large to be pooled.
+   */
+  static size_t sizeClass(size_t size) {
+    return size == 0 ? 0 : (size - 1) / granularity;
+  }
+
+  /**
+   * @brief A freed block, linking to the next free block of the same size class.
+   */
+  typedef struct FreeBlock {
+    FreeBlock* next;
+  } FreeBlock;
+
+  static char* begin;                             /**< The start of the region, nullptr if no region is open */
+  static char* top;                               /**< The first byte not yet handed out */
+  static char* end;                               /**< The end of the region */
+  static FreeBlock* freeLists[regionSizeClasses]; /**< Freed blocks per size class */
+  static size_t liveBlocks;                       /**< The number of blocks handed out and not freed yet */
+};
+
+/**
+ * @brief Base for types whose instances are allocated from the region.
+ */
+typedef struct RegionAllocated {
+  static void* operator new(size_t size) {
+    return Region::allocate(size);
+  }
+
+  static void operator delete(void* ptr, size_t size) {
+    Region::deallocate(ptr, size);
+  }
+} RegionAllocated;
+
+/**
+ * @brief Allocator for standard containers whose buffers should be allocated from the region.
+ */
+template<typename T>
+struct RegionAllocator {
+  using value_type = T;
+
+  RegionAllocator() = default;
+
+  template<typename U>
+  RegionAllocator(const RegionAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(Region::allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    Region::deallocate(ptr, n * sizeof(T));
+  }
+
+  template<typename U>
+  bool operator==(const RegionAllocator<U>&) const {
+    return true;
+  }
+
+  template<typename U>
+  bool operator!=(const RegionAllocator<U>&) const {
+    return false;
+  }
+};
+
+/**
+ * @brief A vector whose buffer is allocated from the region.
+ */
+template<typename T>
+using RegionVector = std::vector<T, RegionAllocator<T>>;
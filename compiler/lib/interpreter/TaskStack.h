@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AstNodes.h"
+#include "Constants.h"
+#include "Environment.h"
+#include "ErrorHandler.h"
+#include "Profiler.h"
+#include "Region.h"
+
+/**
+ * @class TaskStack
+ * @brief The programs, blocks and loops currently being executed, kept in one buffer instead of on the C stack.
+ *
+ * Nesting statements only pushes a task instead of recursing, so the nesting depth of a game is bounded by
+ * `maxNestingDepth` and reported as an error instead of overflowing the small continuation stack.
+ * The buffer is taken from the region once, when the first task is pushed.
+ */
+class TaskStack {
+public:
+  /**
+   * @brief A statement that is executed one step at a time.
+   */
+  typedef struct Task {
+    const AstNodes::Stmt* stmt;  ///< The program, block, while or for statement.
+    Environment* env;            ///< The environment the statements of the task are executed in.
+    Bindings::Binding* counter;  ///< The loop variable in `env`, if `stmt` is a for statement.
+    int32_t bound;               ///< The end of the range, if `stmt` is a for statement.
+    uint16_t next;               ///< The index of the next statement, if `stmt` is a program or a block.
+                                 ///< 1 once the first iteration started, if `stmt` is a for statement.
+    bool ownsScope;              ///< Whether `env` was pushed for this task and ends with it.
+  } Task;
+
+  TaskStack()
+    : tasks(nullptr), depth(0) {}
+
+  ~TaskStack() {
+    if (tasks != nullptr) {
+      Region::deallocateBuffer(tasks, maxNestingDepth * sizeof(Task));
+    }
+  }
+
+  // Delete copy constructor and copy assignment operator
+  TaskStack(const TaskStack&) = delete;
+  TaskStack& operator=(const TaskStack&) = delete;
+
+  /**
+   * @brief Starts a task.
+   * @param stmt The program, block, while or for statement.
+   * @param env The environment the statements are executed in.
+   * @param ownsScope Whether `env` has to be ended together with the task.
+   * @param counter The loop variable, if `stmt` is a for statement.
+   * @param bound The end of the range, if `stmt` is a for statement.
+   * @throws ErrorHandler::restart if the statements are nested deeper than `maxNestingDepth`.
+   */
+  void push(const AstNodes::Stmt* stmt, Environment* env, bool ownsScope, Bindings::Binding* counter = nullptr, int32_t bound = 0) {
+    if (tasks == nullptr) {
+      tasks = static_cast<Task*>(Region::allocateBuffer(maxNestingDepth * sizeof(Task)));
+    }
+    if (depth >= maxNestingDepth) {
+      ErrorHandler::restart("Statements are nested too deeply");
+    }
+    tasks[depth++] = { stmt, env, counter, bound, 0, ownsScope };
+    Profiler::peak(Profiler::Counter::NestingDepth, depth);
+  }
+
+  /**
+   * @brief Returns the innermost task, valid until it is popped.
+   */
+  Task& top() {
+    return tasks[depth - 1];
+  }
+
+  /**
+   * @brief Ends the innermost task.
+   */
+  void pop() {
+    depth--;
+  }
+
+  /**
+   * @brief Returns the number of active tasks.
+   */
+  uint8_t size() const {
+    return depth;
+  }
+
+private:
+  Task* tasks;   /**< The buffer for `maxNestingDepth` tasks */
+  uint8_t depth; /**< The number of active tasks */
+};
@@ -2,16 +2,25 @@
 
 #include <functional>
 #include <map>
+#include <new>
+#include <vector>
 
+#include "AstNodes.h"
 #include "Constants.h"
+#include "Fixed.h"
+#include "Region.h"
+#include "Shape.h"
 
 class Environment;
 
 /**
  * @brief The Values class provides the structure for different types of runtime values.
- * 
- * It contains several value types (Null, Boolean, Number, NativeFn, Break) 
- * and a typedef for a function call handler (FunctionCall).
+ *
+ * Every runtime value is a small tagged `Value`. Null, Boolean and Number are stored
+ * immediately inside of it, as are short strings, builtin functions and user-defined functions. Longer strings, objects, arrays
+ * and closures live on the heap.
+ * Objects and arrays are shared between values through a reference count and copied on write.
+ * All heap parts are allocated from the `Region` of the running game.
  */
 class Values {
 public:
@@ -19,269 +28,566 @@ public:
   /**
    * @brief Enum to define different types of values in the runtime.
    */
-  enum class ValueType {
+  enum class ValueType : uint8_t {
     Null,       ///< Represents a null value.
     Boolean,    ///< Represents a boolean value.
     Number,     ///< Represents a numeric value.
+    Fixed,      ///< Represents a Q16.16 fixed-point numeric value.
     String,     ///< Represents a string value.
     ObjectVal,  ///< Represents an object value.
     ArrayVal,   ///< Represents an array value.
     NativeFn,   ///< Represents a native function value.
-    Break,      ///< Represents a break statement.
+    Function,   ///< Represents a user-defined function value.
   };
 
   /**
-   * @brief A structure representing a runtime value.
-   * 
-   * The base structure includes a type which specifies the kind of value.
+   * @brief The storage representation of array elements.
    */
-  typedef struct RuntimeVal {
-    ValueType type;  ///< The type of the value.
+  enum class ElementKind : uint8_t {
+    Generic,  ///< Elements are stored as `Value`s.
+    Int32,    ///< Numbers are stored packed as `int32_t`s.
+    Bits,     ///< Booleans are stored packed as a bitset.
+  };
+
+  struct Value;
+  struct StringVal;
+  struct ObjectVal;
+  struct ArrayVal;
+  struct NativeClosureVal;
+  struct ArgSpan;
+
+  /**
+   * @brief A native function, takes a span of the evaluated arguments and an environment pointer,
+   * and returns the resulting value.
+   */
+  using NativeFunction = Value (*)(const ArgSpan& args, Environment* env);
+
+  /**
+   * @brief Function call typedef for native functions that need to carry state.
+   */
+  using FunctionCall = std::function<Value(const ArgSpan& args, Environment* env)>;
+
+  static const uint8_t closureBuiltin = UINT8_MAX; /**< Builtin id of native functions that are closures */
+
+  /**
+   * @brief A tagged runtime value.
+   *
+   * Consists of the type tag and a union holding either the immediate value or a pointer to the heap value.
+   * On the ESP8266 this is 8 bytes, so scalar values are passed around without touching the heap.
+   * Copying a string, object, array or closure only increments its reference count.
+   * Moving a value only transfers the pointer.
+   *
+   * Builtin native functions are immediate as well: their id in the builtin table is stored next to the tag
+   * and their function pointer in the union, so they are trivially copyable.
+   *
+   * Short strings (shorter than `inlineStringBytes`) are stored inline: their characters start at `builtin` and
+   * fill the rest of the value including the padding, so they need no heap allocation either.
+   * Immortal strings reference characters that outlive every value, like the string literals of the program, so
+   * they are shared without a reference count and never copied or freed.
+   */
+  typedef struct Value {
+    ValueType type;   ///< The type of the value, selects the active member of the union.
+    uint8_t builtin;  ///< The builtin id if `type` is NativeFn, `closureBuiltin` for closures. Fits in the padding after `type`.
+                      ///< The first inline character if `type` is String, `heapString` for strings on the heap,
+                      ///< `immortalString` for immortal strings.
+
+    union {
+      int number;             ///< The numeric value, if `type` is Number.
+      int32_t fixed;          ///< The raw Q16.16 value, if `type` is Fixed.
+      bool boolean;           ///< The boolean value, if `type` is Boolean.
+      StringVal* string;      ///< The shared string, if `type` is String and `builtin` is `heapString`.
+      const char* chars;      ///< The characters, if `type` is String and `builtin` is `immortalString`. Never freed by the value.
+      ObjectVal* object;      ///< The shared object, if `type` is ObjectVal. Use `mutableObject()` to write to it.
+      ArrayVal* array;        ///< The shared array, if `type` is ArrayVal. Use `mutableArray()` to write to it.
+      NativeFunction nativeFn;    ///< The function pointer, if `type` is NativeFn and `builtin` is not `closureBuiltin`.
+      NativeClosureVal* closure;  ///< The shared closure, if `type` is NativeFn and `builtin` is `closureBuiltin`.
+      const AstNodes::FunctionDeclaration* function;  ///< The declaration, if `type` is Function. Owned by the program, which outlives its values.
+    };
 
     /**
-     * @brief Default constructor initializing the type to Null.
+     * @brief Default constructor initializing the value to null.
      */
-    RuntimeVal()
-      : type(ValueType::Null) {}
+    constexpr Value()
+      : type(ValueType::Null), builtin(0), number(0) {}
+
+    Value(const Value& other);
+    Value(Value&& other) noexcept;
+    Value& operator=(const Value& other);
+    Value& operator=(Value&& other) noexcept;
+    ~Value();
 
     /**
-     * @brief Constructor initializing the value with a specific type.
-     * @param _type The type to initialize the value with.
+     * @brief Checks whether the value is a Number or a Fixed.
      */
-    RuntimeVal(ValueType _type)
-      : type(_type) {}
+    bool isNumeric() const {
+      return type == ValueType::Number || type == ValueType::Fixed;
+    }
 
     /**
-     * @brief Destructor for RuntimeVal.
+     * @brief Returns a numeric value in Q16.16 representation, Numbers are promoted.
+     * @throws ErrorHandler::restart if a Number is outside of the fixed-point range.
      */
-    virtual ~RuntimeVal() = default;
+    int32_t asFixed() const {
+      return type == ValueType::Fixed ? fixed : Fixed::fromInt(number);
+    }
 
     /**
-     * @brief Clone function to create a deep copy of the RuntimeVal.
-     * @return A unique pointer to the cloned RuntimeVal.
+     * @brief Returns a numeric value as a wide fixed-point number, Numbers are converted exactly.
      */
-    virtual std::unique_ptr<RuntimeVal> clone() const = 0;
-  } RuntimeVal;
+    int64_t asWideFixed() const {
+      return type == ValueType::Fixed ? fixed : Fixed::widen(number);
+    }
 
-  /**
-   * @brief A structure representing a null value. Inherits from RuntimeVal.
-   */
-  typedef struct NullVal : RuntimeVal {
     /**
-     * @brief Default constructor initializing the type to Null.
+     * @brief Checks whether the value owns a heap allocated value.
      */
-    NullVal()
-      : RuntimeVal(ValueType::Null) {}
+    bool isHeap() const {
+      return (type == ValueType::String && builtin == heapString) || type == ValueType::ObjectVal || type == ValueType::ArrayVal || isClosure();
+    }
 
     /**
-     * @brief Clone function to create a deep copy of the NullVal.
-     * @return A unique pointer to the cloned NullVal.
+     * @brief Returns the contents of a string value, ropes are flattened.
+     *
+     * The pointer stays valid as long as the value is neither modified nor destroyed.
      */
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<NullVal>();
+    const char* cstr() const;
+
+    /**
+     * @brief Returns the length of a string value without flattening it.
+     */
+    size_t length() const;
+
+    /**
+     * @brief Checks whether the value is a native function carrying state.
+     */
+    bool isClosure() const {
+      return type == ValueType::NativeFn && builtin == closureBuiltin;
     }
-  } NullVal;
 
-  /**
-   * @brief A structure representing a boolean value. Inherits from RuntimeVal.
-   */
-  typedef struct BooleanVal : RuntimeVal {
-    bool value;  ///< The boolean value.
+    /**
+     * @brief Calls the native function, `type` must be NativeFn.
+     * @param args The evaluated arguments of the call.
+     * @param env The environment of the call.
+     * @return The result of the call.
+     */
+    Value call(const ArgSpan& args, Environment* env) const;
+
+    static Value makeNull() {
+      return Value();
+    }
+
+    static Value makeBoolean(bool value) {
+      Value v(ValueType::Boolean);
+      v.boolean = value;
+      return v;
+    }
+
+    static Value makeNumber(int value) {
+      Value v(ValueType::Number);
+      v.number = value;
+      return v;
+    }
 
     /**
-     * @brief Default constructor initializing the value to true.
+     * @brief Creates a fixed-point number.
+     * @param raw The Q16.16 representation of the number.
      */
-    BooleanVal()
-      : RuntimeVal(ValueType::Boolean), value(true) {}
+    static Value makeFixed(int32_t raw) {
+      Value v(ValueType::Fixed);
+      v.fixed = raw;
+      return v;
+    }
 
     /**
-     * @brief Constructor initializing the boolean value to the given value.
-     * @param _value The boolean value to initialize.
+     * @brief Gives write access to the object, copying it first if it is shared with other values.
+     * @return The object only referenced by this value.
      */
-    BooleanVal(bool _value)
-      : RuntimeVal(ValueType::Boolean), value(_value) {}
+    ObjectVal* mutableObject();
 
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<BooleanVal>(*this);
+    /**
+     * @brief Gives write access to the array, copying it first if it is shared with other values.
+     * @return The array only referenced by this value.
+     */
+    ArrayVal* mutableArray();
+
+    static Value makeString(const char* str);
+
+    /**
+     * @brief Creates a string value referencing its characters instead of copying them, short strings are still inlined.
+     * @param str The characters, they must outlive the value and all of its copies.
+     */
+    static Value makeImmortalString(const char* str);
+
+    /**
+     * @brief Concatenates two string values, the result shares both parts instead of copying them.
+     * @param left The left string.
+     * @param right The right string.
+     * @return The concatenated string.
+     */
+    static Value concat(const Value& left, const Value& right);
+    static Value makeObject(Shape* shape);
+    static Value makeArray(ElementKind kind = ElementKind::Generic);
+    /**
+     * @brief Creates a builtin native function.
+     * @param id The index of the function in the builtin table.
+     * @param fn The function.
+     */
+    static Value makeNativeFn(uint8_t id, NativeFunction fn) {
+      Value v(ValueType::NativeFn);
+      v.builtin = id;
+      v.nativeFn = fn;
+      return v;
     }
-  } BooleanVal;
 
-  /**
-   * @brief A structure representing a numeric value. Inherits from RuntimeVal.
-   */
-  typedef struct NumberVal : RuntimeVal {
-    int value;  ///< The numeric value.
+    /**
+     * @brief Creates a user-defined function.
+     * @param declaration The declaration of the function.
+     */
+    static Value makeFunction(const AstNodes::FunctionDeclaration* declaration) {
+      Value v(ValueType::Function);
+      v.function = declaration;
+      return v;
+    }
 
     /**
-     * @brief Default constructor initializing the value to 0.
+     * @brief Creates a native function that carries state, stored on the heap.
+     * @param call The function call handler.
      */
-    NumberVal()
-      : RuntimeVal(ValueType::Number), value(0) {}
+    static Value makeNativeClosure(const FunctionCall& call);
 
+  private:
     /**
-     * @brief Constructor initializing the numeric value to the given value.
-     * @param _value The numeric value to initialize.
+     * @brief Constructor for an immediate value of the given type, the payload is zeroed.
      */
-    NumberVal(int _value)
-      : RuntimeVal(ValueType::Number), value(_value) {}
+    explicit Value(ValueType _type)
+      : type(_type), builtin(0), number(0) {}
 
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<NumberVal>(*this);
+    /**
+     * @brief Returns the inline characters of a short string.
+     */
+    char* inlineChars() {
+      return reinterpret_cast<char*>(&builtin);
     }
-  } NumberVal;
+
+    const char* inlineChars() const {
+      return reinterpret_cast<const char*>(&builtin);
+    }
+
+    /**
+     * @brief Stores a short string inline, if it is shorter than `inlineStringBytes` and its first byte is no marker.
+     * @return Whether the string was stored.
+     */
+    bool storeInline(const char* str);
+
+    /**
+     * @brief Copies the whole representation of `other`, including inline characters in the padding.
+     */
+    void copyBits(const Value& other) {
+      memcpy(static_cast<void*>(this), &other, sizeof(Value));
+    }
+
+    /**
+     * @brief Releases the heap value, if any, and resets to null.
+     */
+    void release();
+
+    /**
+     * @brief Copies the type and payload of `other`, sharing or deep-copying its heap value.
+     */
+    void copyFrom(const Value& other);
+  } Value;
+
+  static_assert(sizeof(Value) <= 2 * sizeof(void*), "Value must stay a tag plus one machine word");
+
+  static const uint8_t heapString = UINT8_MAX;                 /**< Marks strings stored on the heap, never a valid UTF-8 byte */
+  static const uint8_t immortalString = UINT8_MAX - 1;         /**< Marks immortal strings, never a valid UTF-8 byte either */
+  static const size_t inlineStringBytes = sizeof(Value) - 1;   /**< Bytes available for inline strings, including the terminator */
+
+  /**
+   * @brief Intrusive reference count of heap values shared between `Value`s.
+   *
+   * A copied heap value starts out unshared, the count is never copied along.
+   */
+  typedef struct RefCounted : RegionAllocated {
+    uint16_t refCount = 1;  ///< The number of values referencing this heap value.
+
+    RefCounted() = default;
+    RefCounted(const RefCounted&) {}
+    RefCounted& operator=(const RefCounted&) {
+      return *this;
+    }
+
+    /**
+     * @brief Checks whether more than one value references this heap value.
+     */
+    bool shared() const {
+      return refCount > 1;
+    }
+  } RefCounted;
 
   /**
    * @struct StringVal
-   * 
-   * @brief Structure representing a string value. Inherits from RuntimeVal.
+   *
+   * @brief Structure representing the heap part of a string value, either flat or the concatenation of two strings.
+   *
+   * Concatenating strings creates a rope node referencing both parts instead of copying them. A rope is flattened
+   * into one buffer the first time its contents are needed, e.g. when it is printed or compared, and keeps it.
+   * Ropes only grow to the left, the right part is always flat, so flattening and destroying need no recursion.
    */
-  typedef struct StringVal : RuntimeVal {
-    char* str;
+  typedef struct StringVal : RefCounted {
+    size_t length;        ///< The length of the string.
+    mutable char* str;    ///< The contents, nullptr while the string is a rope that has not been flattened.
+    mutable Value left;   ///< The left part, if the string is a rope that has not been flattened.
+    mutable Value right;  ///< The right part, if the string is a rope that has not been flattened, always flat.
 
     StringVal()
-      : RuntimeVal(ValueType::String), str(nullptr) {}
+      : length(0), str(nullptr) {}
     StringVal(const char* _str)
-      : RuntimeVal(ValueType::String) {
-      size_t len = strlen(_str);
-      str = new char[len + 1];
-      strcpy(str, _str);
-      str[len] = '\0';
-    }
-
-    /**
-     * @brief Copy constructor for StringVal.
-     * 
-     * Creates a deep copy of the given StringVal.
-     * @param other The StringVal to copy from.
-     */
-    StringVal(const StringVal& other)
-      : RuntimeVal(other.type) {
-      if (other.str) {
-        size_t len = strlen(other.str);
-        str = new char[len + 1];
-        strcpy(str, other.str);
-      } else {
-        str = nullptr;
-      }
-    }
+      : length(strlen(_str)), str(copyString(_str, length)) {}
 
     /**
-     * @brief Move constructor for StringVal.
-     * 
-     * Transfers ownership of the string from the given StringVal.
-     * @param other The StringVal to move from.
+     * @brief Constructor for a rope node concatenating two strings.
+     * @param _left The left part.
+     * @param _right The right part, must be flat.
      */
-    StringVal(StringVal&& other) noexcept
-      : RuntimeVal(other.type), str(other.str) {
-      other.str = nullptr;
-    }
+    StringVal(Value&& _left, Value&& _right)
+      : length(_left.length() + _right.length()), str(nullptr), left(std::move(_left)), right(std::move(_right)) {}
+
+    // Delete copy constructor and copy assignment operator, strings are immutable and shared instead
+    StringVal(const StringVal&) = delete;
+    StringVal& operator=(const StringVal&) = delete;
+
+    ~StringVal();
 
     /**
-     * @brief Move assignment operator for StringVal.
-     * 
-     * Transfers ownership of the string from the given StringVal.
-     * @param other The StringVal to move from.
-     * @return A reference to this StringVal.
+     * @brief Returns the contents, flattening the rope first if needed.
      */
-    StringVal& operator=(StringVal&& other) noexcept {
-      if (this != &other) {
-        delete[] str;
-        str = other.str;
+    const char* flatten() const;
 
-        other.str = nullptr;
-      }
-      return *this;
+  private:
+    /**
+     * @brief Copies a string into a block of the region.
+     */
+    static char* copyString(const char* _str, size_t len) {
+      char* copy = static_cast<char*>(Region::allocate(len + 1));
+      memcpy(copy, _str, len + 1);
+      return copy;
     }
+  } StringVal;
+
+  /**
+   * @brief Structure representing the heap part of an object value.
+   *
+   * The property names are stored in the shared shape, the values in a flat array in slot order.
+   */
+  typedef struct ObjectVal : RefCounted {
+    Shape* shape;               ///< The property layout, shared with all objects of the same object literal.
+    RegionVector<Value> slots;   ///< The property values, indexed by the slots of `shape`.
 
-    ~StringVal() {
-      delete[] str;
+    ObjectVal(Shape* _shape)
+      : shape(_shape), slots(_shape->size()) {
+      shape->retain();
     }
 
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<StringVal>(*this);
+    ObjectVal(const ObjectVal& other)
+      : RefCounted(other), shape(other.shape), slots(other.slots) {
+      shape->retain();
     }
-  } StringVal;
 
-  typedef struct ObjectVal : RuntimeVal {
-    std::map<String, std::unique_ptr<RuntimeVal>> properties;
+    ObjectVal& operator=(const ObjectVal&) = delete;
 
-    ObjectVal()
-      : RuntimeVal(ValueType::ObjectVal) {}
+    ~ObjectVal() {
+      shape->release();
+    }
 
-    std::unique_ptr<RuntimeVal> clone() const override {
-      std::unique_ptr<ObjectVal> clonedObject = std::make_unique<ObjectVal>();
-      for (const auto& [key, value] : properties) {
-        clonedObject->properties[key] = value->clone();
-      }
-      return clonedObject;
+    /**
+     * @brief Looks up a property by name.
+     * @param key The name of the property.
+     * @return A pointer to the property value or nullptr if the object has no such property.
+     */
+    const Value* property(const char* key) const {
+      uint8_t slot = shape->slotOf(key);
+      return slot == Shape::noSlot ? nullptr : &slots[slot];
     }
   } ObjectVal;
 
-  typedef struct ArrayVal : RuntimeVal {
-    std::vector<std::unique_ptr<RuntimeVal>> elements;
+  /**
+   * @brief Structure representing the heap part of an array value.
+   *
+   * Arrays of only numbers or only booleans are stored packed as `int32_t`s or as a bitset,
+   * all other arrays store their elements as `Value`s. Writing an element that does not fit
+   * the packed representation converts the array to the generic one.
+   */
+  typedef struct ArrayVal : RefCounted {
+    ElementKind kind;  ///< Selects the active member of the union.
 
-    ArrayVal()
-      : RuntimeVal(ValueType::ArrayVal) {}
+    union {
+      RegionVector<Value> elements;   ///< The elements, if `kind` is Generic.
+      RegionVector<int32_t> numbers;  ///< The elements, if `kind` is Int32.
+      RegionVector<bool> booleans;    ///< The elements, if `kind` is Bits.
+    };
 
-    std::unique_ptr<RuntimeVal> clone() const override {
-      std::unique_ptr<ArrayVal> clonedArray = std::make_unique<ArrayVal>();
-      clonedArray->elements.reserve(elements.size());
-      for (size_t i = 0; i < elements.size(); i++) {
-        clonedArray->elements.push_back(elements[i]->clone());
+    /**
+     * @brief Constructor for an empty array.
+     * @param _kind The representation of the elements, should only be packed if all elements fit.
+     */
+    ArrayVal(ElementKind _kind = ElementKind::Generic)
+      : kind(_kind) {
+      switch (kind) {
+        case ElementKind::Generic:
+          new (&elements) RegionVector<Value>();
+          break;
+        case ElementKind::Int32:
+          new (&numbers) RegionVector<int32_t>();
+          break;
+        case ElementKind::Bits:
+          new (&booleans) RegionVector<bool>();
+          break;
       }
-      return clonedArray;
     }
-  } ArrayVal;
 
-  /**
-   * @brief Function call typedef, used to define the type of a callable function.
-   * 
-   * The function takes a vector of unique_ptr of runtime values and an environment pointer, 
-   * and returns a unique_ptr to a runtime value.
-   */
-  using FunctionCall = std::function<std::unique_ptr<RuntimeVal>(std::vector<std::unique_ptr<RuntimeVal>>& args, Environment* env)>;
+    ArrayVal(const ArrayVal& other)
+      : RefCounted(other), kind(other.kind) {
+      switch (kind) {
+        case ElementKind::Generic:
+          new (&elements) RegionVector<Value>(other.elements);
+          break;
+        case ElementKind::Int32:
+          new (&numbers) RegionVector<int32_t>(other.numbers);
+          break;
+        case ElementKind::Bits:
+          new (&booleans) RegionVector<bool>(other.booleans);
+          break;
+      }
+    }
 
-  /**
-   * @brief A structure representing a native function value. Inherits from RuntimeVal.
-   */
-  typedef struct NativeFnVal : RuntimeVal {
-    FunctionCall call;  ///< The native function call handler.
+    ArrayVal& operator=(const ArrayVal&) = delete;
+
+    ~ArrayVal() {
+      destroyElements();
+    }
+
+    /**
+     * @brief Returns the number of elements.
+     */
+    size_t size() const {
+      switch (kind) {
+        case ElementKind::Int32:
+          return numbers.size();
+        case ElementKind::Bits:
+          return booleans.size();
+        default:
+          return elements.size();
+      }
+    }
 
     /**
-     * @brief Default constructor initializing the type to NativeFn.
+     * @brief Reads an element.
+     * @param index The index of the element, must be smaller than `size()`.
+     * @return A copy of the element.
      */
-    NativeFnVal()
-      : RuntimeVal(ValueType::NativeFn) {}
+    Value get(size_t index) const;
 
     /**
-     * @brief Constructor initializing the native function value with a function call handler.
-     * @param _call The function call handler to initialize the native function value with.
+     * @brief Overwrites an element, converting the array to the generic representation if the value does not fit.
+     * @param index The index of the element, must be smaller than `size()`.
+     * @param value The new element.
      */
-    NativeFnVal(FunctionCall _call)
-      : RuntimeVal(ValueType::NativeFn), call(_call) {}
+    void set(size_t index, Value&& value);
+
     /**
-     * @brief Clone function to create a deep copy of the NativeFnVal.
-     * @return A unique pointer to the cloned NativeFnVal.
+     * @brief Appends an element, converting the array to the generic representation if the value does not fit.
+     * @param value The new element.
      */
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<NativeFnVal>(*this);
+    void push(Value&& value);
+
+    /**
+     * @brief Gives a reference to an element, converting the array to the generic representation first.
+     * @param index The index of the element, must be smaller than `size()`.
+     */
+    Value& elementRef(size_t index) {
+      toGeneric();
+      return elements[index];
+    }
+
+    void reserve(size_t count);
+
+    /**
+     * @brief Switches a generic array to a packed representation if all of its elements fit one.
+     */
+    void pack();
+
+    /**
+     * @brief Switches a packed array to the generic representation.
+     */
+    void toGeneric();
+
+  private:
+    /**
+     * @brief Checks whether a value can be stored in the current representation.
+     */
+    bool fits(const Value& value) const {
+      switch (kind) {
+        case ElementKind::Int32:
+          return value.type == ValueType::Number;
+        case ElementKind::Bits:
+          return value.type == ValueType::Boolean;
+        default:
+          return true;
+      }
     }
-  } NativeFnVal;
+
+    void destroyElements() {
+      switch (kind) {
+        case ElementKind::Generic:
+          elements.~vector();
+          break;
+        case ElementKind::Int32:
+          numbers.~vector();
+          break;
+        case ElementKind::Bits:
+          booleans.~vector();
+          break;
+      }
+    }
+  } ArrayVal;
 
   /**
-   * @brief A structure representing a break value. Inherits from RuntimeVal.
+   * @brief A fixed-size view over the evaluated arguments of a function call.
+   *
+   * The arguments live in an on-stack buffer of the caller (at most `maxFunctionArgs`),
+   * so handing them to a native function does not allocate.
    */
-  typedef struct BreakVal : RuntimeVal {
+  typedef struct ArgSpan {
+    const Value* args;   ///< The first argument of the call.
+    uint8_t size;        ///< The number of arguments.
+    const char* callee;  ///< The name of the called function, used in error messages.
+
     /**
-     * @brief Default constructor initializing the type to Break.
+     * @brief Accesses an argument of the call.
+     * @param i The index of the argument, must be smaller than `size`.
+     * @return The argument.
      */
-    BreakVal()
-      : RuntimeVal(ValueType::Break) {}
-
-    std::unique_ptr<RuntimeVal> clone() const override {
-      return std::make_unique<BreakVal>(*this);
+    const Value& operator[](uint8_t i) const {
+      return args[i];
     }
-  } BreakVal;
+  } ArgSpan;
+
+  /**
+   * @brief Structure representing the heap part of a native function that carries state.
+   *
+   * Builtins do not need this, they are stored as plain function pointers inside of the value.
+   */
+  typedef struct NativeClosureVal : RefCounted {
+    FunctionCall call;  ///< The native function call handler.
+
+    /**
+     * @brief Constructor initializing the closure with a function call handler.
+     * @param _call The function call handler to initialize the closure with.
+     */
+    NativeClosureVal(FunctionCall _call)
+      : call(_call) {}
+  } NativeClosureVal;
 
   static String getString(ValueType valueType) {
     return valueTypeString.at(valueType);
@@ -292,10 +598,368 @@ private:
     { ValueType::Null, "Null" },
     { ValueType::Boolean, "Boolean" },
     { ValueType::Number, "Number" },
+    { ValueType::Fixed, "Fixed" },
     { ValueType::String, "String" },
     { ValueType::ObjectVal, "ObjectVal" },
     { ValueType::ArrayVal, "ArrayVal" },
     { ValueType::NativeFn, "NativeFn" },
-    { ValueType::Break, "Break" }
+    { ValueType::Function, "Function" }
   };
-};
\ No newline at end of file
+};
+
+inline Values::Value::Value(const Value& other)
+  : type(ValueType::Null), builtin(0), number(0) {
+  copyFrom(other);
+}
+
+inline Values::Value::Value(Value&& other) noexcept {
+  copyBits(other);
+  other.type = ValueType::Null;
+  other.builtin = 0;
+  other.number = 0;
+}
+
+inline Values::Value& Values::Value::operator=(const Value& other) {
+  if (this != &other) {
+    Value copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+inline Values::Value& Values::Value::operator=(Value&& other) noexcept {
+  if (this != &other) {
+    release();
+    copyBits(other);
+    other.type = ValueType::Null;
+    other.builtin = 0;
+    other.number = 0;
+  }
+  return *this;
+}
+
+inline Values::Value::~Value() {
+  release();
+}
+
+inline void Values::Value::release() {
+  switch (type) {
+    case ValueType::String:
+      if (builtin == heapString && --string->refCount == 0) {
+        delete string;
+      }
+      break;
+    case ValueType::ObjectVal:
+      if (--object->refCount == 0) {
+        delete object;
+      }
+      break;
+    case ValueType::ArrayVal:
+      if (--array->refCount == 0) {
+        delete array;
+      }
+      break;
+    case ValueType::NativeFn:
+      if (builtin == closureBuiltin && --closure->refCount == 0) {
+        delete closure;
+      }
+      break;
+    default:
+      break;
+  }
+  type = ValueType::Null;
+  builtin = 0;
+  number = 0;
+}
+
+inline void Values::Value::copyFrom(const Value& other) {
+  copyBits(other);
+  switch (type) {
+    case ValueType::String:
+      if (builtin == heapString) {
+        string->refCount++;
+      }
+      break;
+    case ValueType::ObjectVal:
+      object->refCount++;
+      break;
+    case ValueType::ArrayVal:
+      array->refCount++;
+      break;
+    case ValueType::NativeFn:
+      if (builtin == closureBuiltin) {
+        closure->refCount++;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+inline Values::ObjectVal* Values::Value::mutableObject() {
+  if (object->shared()) {
+    // the copy shares the property values, they are copied on their own writes
+    object->refCount--;
+    object = new ObjectVal(*object);
+  }
+  return object;
+}
+
+inline Values::ArrayVal* Values::Value::mutableArray() {
+  if (array->shared()) {
+    array->refCount--;
+    array = new ArrayVal(*array);
+  }
+  return array;
+}
+
+inline const char* Values::Value::cstr() const {
+  if (builtin == heapString) {
+    return string->flatten();
+  }
+  return builtin == immortalString ? chars : inlineChars();
+}
+
+inline size_t Values::Value::length() const {
+  if (builtin == heapString) {
+    return string->length;
+  }
+  return strlen(builtin == immortalString ? chars : inlineChars());
+}
+
+inline bool Values::Value::storeInline(const char* str) {
+  size_t len = strlen(str);
+  if (len >= inlineStringBytes || (uint8_t)str[0] >= immortalString) {
+    return false;
+  }
+  memcpy(inlineChars(), str, len + 1);
+  return true;
+}
+
+inline Values::Value Values::Value::makeString(const char* str) {
+  Value v(ValueType::String);
+  if (!v.storeInline(str)) {
+    v.builtin = heapString;
+    v.string = new StringVal(str);
+  }
+  return v;
+}
+
+inline Values::Value Values::Value::makeImmortalString(const char* str) {
+  Value v(ValueType::String);
+  if (!v.storeInline(str)) {
+    v.builtin = immortalString;
+    v.chars = str;
+  }
+  return v;
+}
+
+inline Values::Value Values::Value::concat(const Value& left, const Value& right) {
+  size_t leftLen = left.length();
+  size_t rightLen = right.length();
+  if (leftLen == 0) {
+    return right;
+  }
+  if (rightLen == 0) {
+    return left;
+  }
+
+  if (leftLen + rightLen < inlineStringBytes) {
+    char buf[inlineStringBytes];
+    memcpy(buf, left.cstr(), leftLen);
+    memcpy(buf + leftLen, right.cstr(), rightLen + 1);
+    return makeString(buf);
+  }
+
+  // keep ropes growing to the left only, appending in a loop never flattens anything
+  Value flatRight = right;
+  flatRight.cstr();
+
+  Value v(ValueType::String);
+  v.builtin = heapString;
+  v.string = new StringVal(Value(left), std::move(flatRight));
+  return v;
+}
+
+inline Values::StringVal::~StringVal() {
+  if (str != nullptr) {
+    Region::deallocate(str, length + 1);
+  }
+
+  // unlink the left spine one node at a time, destroying a long rope recursively could exhaust the stack
+  Value next = std::move(left);
+  while (next.isHeap() && !next.string->shared()) {
+    Value nextLeft = std::move(next.string->left);
+    next = std::move(nextLeft);
+  }
+}
+
+inline const char* Values::StringVal::flatten() const {
+  if (str != nullptr) {
+    return str;
+  }
+  if (left.type != ValueType::String) {
+    return "";
+  }
+
+  char* buf = static_cast<char*>(Region::allocate(length + 1));
+  buf[length] = '\0';
+
+  // fill the buffer from the back while walking down the left spine, every right part is flat
+  size_t end = length;
+  const StringVal* node = this;
+  while (true) {
+    size_t rightLen = node->right.length();
+    end -= rightLen;
+    memcpy(buf + end, node->right.cstr(), rightLen);
+
+    const Value& nodeLeft = node->left;
+    if (nodeLeft.isHeap() && nodeLeft.string->str == nullptr && nodeLeft.string->left.type == ValueType::String) {
+      node = nodeLeft.string;
+    } else {
+      memcpy(buf, nodeLeft.cstr(), end);
+      break;
+    }
+  }
+
+  str = buf;
+  left = Value();
+  right = Value();
+  return str;
+}
+
+inline Values::Value Values::Value::makeObject(Shape* shape) {
+  Value v(ValueType::ObjectVal);
+  v.object = new ObjectVal(shape);
+  return v;
+}
+
+inline Values::Value Values::Value::makeArray(ElementKind kind) {
+  Value v(ValueType::ArrayVal);
+  v.array = new ArrayVal(kind);
+  return v;
+}
+
+inline Values::Value Values::Value::makeNativeClosure(const FunctionCall& call) {
+  Value v(ValueType::NativeFn);
+  v.builtin = closureBuiltin;
+  v.closure = new NativeClosureVal(call);
+  return v;
+}
+
+inline Values::Value Values::Value::call(const ArgSpan& args, Environment* env) const {
+  return builtin == closureBuiltin ? closure->call(args, env) : nativeFn(args, env);
+}
+
+inline Values::Value Values::ArrayVal::get(size_t index) const {
+  switch (kind) {
+    case ElementKind::Int32:
+      return Value::makeNumber(numbers[index]);
+    case ElementKind::Bits:
+      return Value::makeBoolean(booleans[index]);
+    default:
+      return elements[index];
+  }
+}
+
+inline void Values::ArrayVal::set(size_t index, Value&& value) {
+  if (!fits(value)) {
+    toGeneric();
+  }
+
+  switch (kind) {
+    case ElementKind::Int32:
+      numbers[index] = value.number;
+      break;
+    case ElementKind::Bits:
+      booleans[index] = value.boolean;
+      break;
+    default:
+      elements[index] = std::move(value);
+      break;
+  }
+}
+
+inline void Values::ArrayVal::push(Value&& value) {
+  if (!fits(value)) {
+    toGeneric();
+  }
+
+  switch (kind) {
+    case ElementKind::Int32:
+      numbers.push_back(value.number);
+      break;
+    case ElementKind::Bits:
+      booleans.push_back(value.boolean);
+      break;
+    default:
+      elements.push_back(std::move(value));
+      break;
+  }
+}
+
+inline void Values::ArrayVal::reserve(size_t count) {
+  switch (kind) {
+    case ElementKind::Int32:
+      numbers.reserve(count);
+      break;
+    case ElementKind::Bits:
+      booleans.reserve(count);
+      break;
+    default:
+      elements.reserve(count);
+      break;
+  }
+}
+
+inline void Values::ArrayVal::pack() {
+  if (kind != ElementKind::Generic || elements.empty()) {
+    return;
+  }
+
+  ValueType elementType = elements[0].type;
+  if (elementType != ValueType::Number && elementType != ValueType::Boolean) {
+    return;
+  }
+
+  for (size_t i = 1; i < elements.size(); i++) {
+    if (elements[i].type != elementType) {
+      return;
+    }
+  }
+
+  RegionVector<Value> generic = std::move(elements);
+  destroyElements();
+
+  if (elementType == ValueType::Number) {
+    kind = ElementKind::Int32;
+    new (&numbers) RegionVector<int32_t>();
+    numbers.reserve(generic.size());
+    for (size_t i = 0; i < generic.size(); i++) {
+      numbers.push_back(generic[i].number);
+    }
+  } else {
+    kind = ElementKind::Bits;
+    new (&booleans) RegionVector<bool>();
+    booleans.reserve(generic.size());
+    for (size_t i = 0; i < generic.size(); i++) {
+      booleans.push_back(generic[i].boolean);
+    }
+  }
+}
+
+inline void Values::ArrayVal::toGeneric() {
+  if (kind == ElementKind::Generic) {
+    return;
+  }
+
+  RegionVector<Value> generic;
+  generic.reserve(size());
+  for (size_t i = 0; i < size(); i++) {
+    generic.push_back(get(i));
+  }
+
+  destroyElements();
+  kind = ElementKind::Generic;
+  new (&elements) RegionVector<Value>(std::move(generic));
+}
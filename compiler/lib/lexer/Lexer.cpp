@@ -29,12 +29,13 @@ std::queue<Lexer::Token> Lexer::tokenize(char* code, size_t len) {
       case '*':
       case '/':
       case '%':
-        if (code[i] == '-' && i + 1 < len && isDigit(code[i + 1])) {
+        if ((code[i] == '+' || code[i] == '-') && i + 1 < len && (code[i + 1] == code[i] || code[i + 1] == '=')) {
+          // "++", "--", "+=" and "-="
+          addToken(&code[i], 2, code[i + 1] == '=' ? TokenType::CompoundAssignment : TokenType::IncrementOperator, tokens);
+          i++;
+        } else if (code[i] == '-' && i + 1 < len && isDigit(code[i + 1])) {
           // negative number
-          size_t numLen = 1;
-          while (i + numLen < len && isDigit(code[i + numLen])) {
-            numLen++;
-          }
+          size_t numLen = 1 + numberLength(code, i + 1, len);
 
           addToken(&code[i], numLen, TokenType::Number, tokens);
           i += numLen - 1;
@@ -76,7 +77,12 @@ std::queue<Lexer::Token> Lexer::tokenize(char* code, size_t len) {
         addToken(&code[i], 1, TokenType::Comma, tokens);
         break;
       case '.':
-        addToken(&code[i], 1, TokenType::Dot, tokens);
+        if (i + 1 < len && code[i + 1] == '.') {
+          addToken(&code[i], 2, TokenType::Range, tokens);
+          i++;
+        } else {
+          addToken(&code[i], 1, TokenType::Dot, tokens);
+        }
         break;
       case '"':
         {
@@ -97,10 +103,7 @@ std::queue<Lexer::Token> Lexer::tokenize(char* code, size_t len) {
         // handle multicharacter tokens
         if (isDigit(code[i])) {
           // number
-          size_t numLen = 1;
-          while (i + numLen < len && isDigit(code[i + numLen])) {
-            numLen++;
-          }
+          size_t numLen = numberLength(code, i, len);
 
           addToken(&code[i], numLen, TokenType::Number, tokens);
           i += numLen - 1;
@@ -120,7 +123,11 @@ std::queue<Lexer::Token> Lexer::tokenize(char* code, size_t len) {
             }
           }
 
-          addToken(&code[i], identLen, tokenType, tokens);
+          if (tokenType == TokenType::Identifier) {
+            tokens.push(Token(Symbols::intern(&code[i], identLen)));
+          } else {
+            addToken(&code[i], identLen, tokenType, tokens);
+          }
           i += identLen - 1;
         } else if (!isSpace(code[i]) && code[i] != '\0') {
           unrecognizedCharacter(code[i]);
@@ -145,6 +152,23 @@ void Lexer::addToken(const char* src, size_t srcLen, TokenType tokenType, std::q
   tokens.push(Token(value, tokenType));
 }
 
+size_t Lexer::numberLength(const char* code, size_t start, size_t len) {
+  size_t numLen = 0;
+  while (start + numLen < len && isDigit(code[start + numLen])) {
+    numLen++;
+  }
+
+  // a '.' only starts a fraction if a digit follows, so "1..5" and "1.foo" are left alone
+  if (start + numLen + 1 < len && code[start + numLen] == '.' && isDigit(code[start + numLen + 1])) {
+    numLen++;
+    while (start + numLen < len && isDigit(code[start + numLen])) {
+      numLen++;
+    }
+  }
+
+  return numLen;
+}
+
 void Lexer::unrecognizedCharacter(char c) {
   char errMsg[30];
   Serial.print("Unrecognized character: ");
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "Constants.h"
 #include "ErrorHandler.h"
+#include "Symbols.h"
 
 /**
  * @class Lexer
@@ -29,12 +30,19 @@ public:
     Else,   ///< Token for the 'else' keyword
     While,  ///< Token for the 'while' keyword
     Break,  ///< Token for the 'break' keyword
+    Continue, ///< Token for the 'continue' keyword
+    Fn,     ///< Token for the 'fn' keyword
+    Return, ///< Token for the 'return' keyword
+    For,    ///< Token for the 'for' keyword
+    In,     ///< Token for the 'in' keyword
 
     Identifier,     ///< Token for identifiers (variable names, etc.)
-    Number,         ///< Token for numerical literals
+    Number,         ///< Token for numerical literals (integers or decimals)
     StringLiteral,  ///< Token for string literals
 
     Equals,              ///< Token for '=' operator
+    CompoundAssignment,  ///< Token for compound assignment operators (+=, -=)
+    IncrementOperator,   ///< Token for increment and decrement operators (++, --)
     ArithmeticOperator,  ///< Token for arithmetic operators (+, -, *, /, %)
     RelationalOperator,  ///< Token for relational operators (<, <=, >, >=, ==, !=)
     LogicalOperator,     ///< Token for logical operators (not, and, or)
@@ -50,6 +58,7 @@ public:
     Colon,      ///< Token for ':' character
     Comma,      ///< Token for ',' character
     Dot,        ///< Token for '.' character
+    Range,      ///< Token for '..' characters
 
     EndOfFile,  ///< Token indicating the end of the file
   };
@@ -60,10 +69,12 @@ public:
    *
    * A token consists of a string value and a type that indicates what kind of
    * token it is (e.g., identifier, keyword, operator).
+   * Identifiers are interned while lexing, they only carry their symbol id and no value.
    */
   typedef struct Token {
-    char* value;     ///< The value of the token (e.g., the string representation of the identifier)
+    char* value;     ///< The value of the token (e.g., the string representation of the operator), nullptr for identifiers
     TokenType type;  ///< The type of the token (e.g., keyword, operator)
+    uint16_t symbol; ///< The interned symbol id, if the token is an identifier
 
     /**
      * @brief Default constructor.
@@ -71,7 +82,7 @@ public:
      * Initializes the token with an empty value and an Identifier type.
      */
     Token()
-      : value(nullptr), type(TokenType::Identifier) {}
+      : value(nullptr), type(TokenType::Identifier), symbol(Symbols::noSymbol) {}
 
     /**
      * @brief Parameterized constructor.
@@ -79,7 +90,14 @@ public:
      * @param _type The type of the token.
      */
     Token(char* _value, TokenType _type)
-      : value(_value), type(_type) {}
+      : value(_value), type(_type), symbol(Symbols::noSymbol) {}
+
+    /**
+     * @brief Constructor for identifiers.
+     * @param _symbol The interned symbol id of the identifier.
+     */
+    Token(uint16_t _symbol)
+      : value(nullptr), type(TokenType::Identifier), symbol(_symbol) {}
 
     /**
      * @brief Parameterized constructor.
@@ -87,7 +105,7 @@ public:
      * @param _type The type of the token.
      */
     Token(const char* _value, TokenType _type)
-      : type(_type) {
+      : type(_type), symbol(Symbols::noSymbol) {
       if (_value) {
         size_t strLen = strlen(_value) + 1;
         value = new char[strLen];
@@ -103,7 +121,7 @@ public:
      * @param other The token to copy from.
      */
     Token(const Token& other)
-      : type(other.type) {
+      : type(other.type), symbol(other.symbol) {
       if (other.value) {
         size_t strLen = strlen(other.value) + 1;
         value = new char[strLen];
@@ -119,7 +137,7 @@ public:
      * @param other The token to move from.
      */
     Token(Token&& other) noexcept
-      : value(other.value), type(other.type) {
+      : value(other.value), type(other.type), symbol(other.symbol) {
       other.value = nullptr;  // Transfer ownership
     }
 
@@ -132,12 +150,20 @@ public:
         delete[] value;       // Free existing memory
         value = other.value;  // Transfer ownership
         type = other.type;
+        symbol = other.symbol;
         other.value = nullptr;
       }
       return *this;
     }
 
 
+    /**
+     * @brief Returns the text of the token, the interned name for identifiers.
+     */
+    const char* text() const {
+      return symbol != Symbols::noSymbol ? Symbols::name(symbol) : value;
+    }
+
     /**
      * @brief Destructor.
      * Frees the memory allocated for the token's value.
@@ -169,6 +195,11 @@ private:
     Token("else", TokenType::Else),
     Token("while", TokenType::While),
     Token("break", TokenType::Break),
+    Token("continue", TokenType::Continue),
+    Token("fn", TokenType::Fn),
+    Token("return", TokenType::Return),
+    Token("for", TokenType::For),
+    Token("in", TokenType::In),
     Token("and", TokenType::LogicalOperator),
     Token("or", TokenType::LogicalOperator),
   };
@@ -184,5 +215,13 @@ private:
    */
   void addToken(const char* src, size_t srcLen, TokenType tokenType, std::queue<Token>& tokens);
 
+  /**
+   * @brief Returns the length of the number starting at `start`, including an optional decimal fraction.
+   * @param code The source code.
+   * @param start The index of the first digit.
+   * @param len The length of the source code.
+   */
+  size_t numberLength(const char* code, size_t start, size_t len);
+
   void unrecognizedCharacter(char c);
 };
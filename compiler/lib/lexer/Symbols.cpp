@@ -0,0 +1,58 @@
+#include "Symbols.h"
+
+std::vector<char*> Symbols::names;
+uint16_t* Symbols::index = nullptr;
+size_t Symbols::indexCapacity = 0;
+
+uint16_t Symbols::intern(const char* name, size_t len) {
+  // keep the load factor at most 3/4
+  if ((names.size() + 1) * 4 > indexCapacity * 3) {
+    grow();
+  }
+
+  size_t i = slotOf(name, len);
+  if (index[i] == noSymbol) {
+    if (names.size() >= maxSymbols) {
+      ErrorHandler::restart("Too many distinct identifiers");
+    }
+
+    char* copy = new char[len + 1];
+    memcpy(copy, name, len);
+    copy[len] = '\0';
+    names.push_back(copy);
+    index[i] = names.size() - 1;
+  }
+  return index[i];
+}
+
+uint16_t Symbols::find(const char* name) {
+  return indexCapacity == 0 ? noSymbol : index[slotOf(name, strlen(name))];
+}
+
+size_t Symbols::slotOf(const char* name, size_t len) {
+  size_t mask = indexCapacity - 1;
+  size_t i = hash(name, len) & mask;
+  while (index[i] != noSymbol && (strncmp(names[index[i]], name, len) != 0 || names[index[i]][len] != '\0')) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void Symbols::grow() {
+  size_t newCapacity = indexCapacity == 0 ? estimatedSymbols : indexCapacity * 2;
+  uint16_t* newIndex = new uint16_t[newCapacity];
+  memset(newIndex, 0xFF, newCapacity * sizeof(uint16_t));
+
+  size_t mask = newCapacity - 1;
+  for (uint16_t id = 0; id < names.size(); id++) {
+    size_t i = hash(names[id], strlen(names[id])) & mask;
+    while (newIndex[i] != noSymbol) {
+      i = (i + 1) & mask;
+    }
+    newIndex[i] = id;
+  }
+
+  delete[] index;
+  index = newIndex;
+  indexCapacity = newCapacity;
+}
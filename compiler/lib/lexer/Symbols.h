@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "Constants.h"
+#include "ErrorHandler.h"
+
+/**
+ * @class Symbols
+ * @brief Interns identifier names, so names can be compared and looked up by a small integer id.
+ *
+ * Every distinct name gets the next free id the first time it is interned, the same name always maps to the same id.
+ * The lexer interns every identifier, so the parser, environments and objects only store and compare ids,
+ * the names are only needed again for diagnostics and printing.
+ * Interned names are kept for the whole lifetime of the program, they are bounded by the identifiers of the scripts.
+ */
+class Symbols {
+public:
+  /**
+   * @brief Returns the id of a name, interning it first if it has not been seen before.
+   * @param name The name (will be copied).
+   * @return The id of the name.
+   */
+  static uint16_t intern(const char* name) {
+    return intern(name, strlen(name));
+  }
+
+  /**
+   * @brief Returns the id of a name that is not null terminated, interning it first if it has not been seen before.
+   * @param name The start of the name (will be copied).
+   * @param len The length of the name.
+   * @return The id of the name.
+   */
+  static uint16_t intern(const char* name, size_t len);
+
+  /**
+   * @brief Returns the id of a name without interning it.
+   * @param name The name.
+   * @return The id of the name or `noSymbol` if it was never interned.
+   */
+  static uint16_t find(const char* name);
+
+  /**
+   * @brief Returns the name of an interned id.
+   */
+  static const char* name(uint16_t id) {
+    return names[id];
+  }
+
+  /**
+   * @brief Returns the number of interned names.
+   */
+  static uint16_t count() {
+    return names.size();
+  }
+
+  /**
+   * @brief FNV-1a hash of a name.
+   */
+  static uint32_t hash(const char* name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+      h = (h ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return h;
+  }
+
+  static const uint16_t maxSymbols = 0x7FFF; /**< Ids use 15 bits, so users can pack a flag next to them */
+  static const uint16_t noSymbol = UINT16_MAX; /**< Returned by `find` for unknown names, never a valid id */
+
+private:
+  /**
+   * @brief Rebuilds the hash index with twice the capacity.
+   */
+  static void grow();
+
+  /**
+   * @brief Looks up the slot of the hash index holding a name, or the empty slot it would be inserted into.
+   */
+  static size_t slotOf(const char* name, size_t len);
+
+  static std::vector<char*> names;  /**< The interned names, indexed by id */
+  static uint16_t* index;           /**< Open addressing hash index of ids, probed linearly */
+  static size_t indexCapacity;      /**< The capacity of the index, a power of two */
+};
@@ -4,7 +4,10 @@
 #include <vector>
 #include <map>
 
+#include "ConstantPool.h"
 #include "Constants.h"
+#include "Shape.h"
+#include "Symbols.h"
 
 class AstNodes {
 public:
@@ -19,10 +22,15 @@ public:
     VarDeclaration, /**< Represents a variable declaration */
     IfStmt,         /**< Represents an if statement */
     WhileStmt,      /**< Represents a while statement */
+    ForStmt,        /**< Represents a for statement over a range */
     BreakStmt,      /**< Represents a break statement */
+    ContinueStmt,   /**< Represents a continue statement */
     BlockStmt,      /**< Represents a block statement */
+    FunctionDeclaration, /**< Represents a function declaration */
+    ReturnStmt,     /**< Represents a return statement */
     // Expressions
     AssignmentExpr, /**< Represents an assignment expression */
+    UpdateExpr,     /**< Represents a compound assignment, increment or decrement */
     CallExpr,       /**< Represents a function call expression */
     MemberExpr,     /**< Represents a object/array member access */
     // Literals
@@ -35,6 +43,31 @@ public:
     LogicalExpr     /**< Represents a logical expression */
   };
 
+  /**
+   * @enum Specialization
+   * 
+   * The variant a node was rewritten to by the interpreter after its first execution, chosen by the types it saw.
+   * A specialized node whose types do not match anymore falls back to `Generic` for good.
+   */
+  enum class Specialization : uint8_t {
+    Unquickened,  /**< The node was not executed yet */
+    Generic,      /**< The node saw types no variant covers */
+    Int,          /**< A binary expression of two numbers */
+    ArrayIndex,   /**< A member expression indexing an array with a number */
+    NativeCall,   /**< A call of a native function by name */
+    FunctionCall  /**< A call of a user-defined function by name */
+  };
+
+  /**
+   * @enum BinaryOp
+   * 
+   * The operator of a binary expression, decoded once by the parser.
+   */
+  enum class BinaryOp : uint8_t {
+    Add, Subtract, Multiply, Divide, Modulo,
+    Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual
+  };
+
   /**
    * @struct Stmt
    * 
@@ -55,6 +88,7 @@ public:
    */
   typedef struct Program : Stmt {
     std::vector<std::unique_ptr<Stmt>> body; /**< A list of statements within the program */
+    ConstantPool constants;                  /**< The contents of the string literals, referenced by immortal string values */
 
     Program()
       : Stmt(NodeType::Program) {
@@ -89,19 +123,15 @@ public:
    */
   typedef struct VarDeclaration : Stmt {
     bool constant;               /**< Whether the variable is constant */
-    char* ident;                 /**< The identifier (name) of the variable */
+    uint16_t ident;              /**< The interned symbol id of the variable name */
     std::unique_ptr<AstNodes::Expr> value; /**< The expression representing the value assigned to the variable */
 
     VarDeclaration()
-      : Stmt(NodeType::VarDeclaration), constant(false), ident(nullptr), value(nullptr) {}
+      : Stmt(NodeType::VarDeclaration), constant(false), ident(Symbols::noSymbol), value(nullptr) {}
 
     // Delete copy constructor and copy assignment operator
     VarDeclaration(const VarDeclaration&) = delete;
     VarDeclaration& operator=(const VarDeclaration&) = delete;
-
-    ~VarDeclaration() {
-      delete[] ident;
-    }
   } VarDeclaration;
 
   /**
@@ -121,6 +151,26 @@ public:
     AssignmentExpr& operator=(const AssignmentExpr&) = delete;
   } AssignmentExpr;
 
+  /**
+   * @struct UpdateExpr
+   * 
+   * Represents `target += value`, `target -= value`, `target++` and `target--`.
+   * Numbers are updated in place, without evaluating a binary expression and reassigning the result.
+   * `target++` and `target--` evaluate to the value before the update, like in C.
+   */
+  typedef struct UpdateExpr : Expr {
+    std::unique_ptr<AstNodes::Expr> target; /**< The updated identifier or member expression */
+    std::unique_ptr<AstNodes::Expr> value;  /**< The added or subtracted expression, nullptr for an increment or decrement by one */
+    BinaryOp op;                            /**< `Add` or `Subtract` */
+
+    UpdateExpr()
+      : Expr(NodeType::UpdateExpr), target(nullptr), value(nullptr), op(BinaryOp::Add) {}
+
+    // Delete copy constructor and copy assignment operator
+    UpdateExpr(const UpdateExpr&) = delete;
+    UpdateExpr& operator=(const UpdateExpr&) = delete;
+  } UpdateExpr;
+
   /**
    * @struct CallExpr
    * 
@@ -130,8 +180,10 @@ public:
     std::unique_ptr<AstNodes::Expr> caller;            /**< The function being called */
     std::vector<std::unique_ptr<AstNodes::Expr>> args; /**< A list of arguments passed to the function */
 
+    mutable Specialization specialization; /**< The kind of function the call saw, only specialized if `caller` is an identifier */
+
     CallExpr()
-      : Expr(NodeType::CallExpr) {
+      : Expr(NodeType::CallExpr), specialization(Specialization::Unquickened) {
       args.reserve(estimatedFunctionArgs);
     }
     // Delete copy constructor and copy assignment operator
@@ -150,8 +202,13 @@ public:
     std::unique_ptr<AstNodes::Expr> property;
     bool computed;
 
+    mutable const Shape* cachedShape; /**< The object shape `property` was last resolved on, only used if not computed */
+    mutable uint8_t cachedSlot;       /**< The slot of `property` in `cachedShape` */
+    mutable Specialization specialization; /**< `ArrayIndex` once the access saw an array and a numeric index */
+
     MemberExpr()
-      : Expr(NodeType::MemberExpr), object(nullptr), property(nullptr), computed(false) {}
+      : Expr(NodeType::MemberExpr), object(nullptr), property(nullptr), computed(false), cachedShape(nullptr), cachedSlot(Shape::noSlot),
+        specialization(Specialization::Unquickened) {}
 
     // Delete copy constructor and copy assignment operator
     MemberExpr(const MemberExpr&) = delete;
@@ -168,8 +225,47 @@ public:
     std::unique_ptr<AstNodes::Expr> right; /**< The right operand */
     char* op;                    /**< The operator (e.g., "+", "-", "*", "/") */
 
+    BinaryOp opcode;                       /**< The decoded `op`, set by the parser */
+    mutable Specialization specialization; /**< `Int` once the expression saw two numbers */
+
     BinaryExpr()
-      : Expr(NodeType::BinaryExpr), left(nullptr), right(nullptr), op(nullptr) {}
+      : Expr(NodeType::BinaryExpr), left(nullptr), right(nullptr), op(nullptr), opcode(BinaryOp::Add), specialization(Specialization::Unquickened) {}
+
+    /**
+     * @brief Decodes an operator string of the lexer.
+     * @param op An arithmetic or relational operator, the only ones the parser builds binary expressions of.
+     */
+    static BinaryOp decode(const char* op) {
+      bool orEqual = op[1] == '=';
+      switch (op[0]) {
+        case '+':
+          return BinaryOp::Add;
+        case '-':
+          return BinaryOp::Subtract;
+        case '*':
+          return BinaryOp::Multiply;
+        case '/':
+          return BinaryOp::Divide;
+        case '%':
+          return BinaryOp::Modulo;
+        case '<':
+          return orEqual ? BinaryOp::LessEqual : BinaryOp::Less;
+        case '>':
+          return orEqual ? BinaryOp::GreaterEqual : BinaryOp::Greater;
+        case '=':
+          return BinaryOp::Equal;
+        default:
+          return BinaryOp::NotEqual;
+      }
+    }
+
+    /**
+     * @brief Returns the operator string of a decoded operator, for messages and printing.
+     */
+    static const char* symbol(BinaryOp opcode) {
+      static const char* const symbols[] = { "+", "-", "*", "/", "%", "<", "<=", ">", ">=", "==", "!=" };
+      return symbols[static_cast<uint8_t>(opcode)];
+    }
 
     // Delete copy constructor and copy assignment operator
     BinaryExpr(const BinaryExpr&) = delete;
@@ -186,18 +282,20 @@ public:
    * Represents an identifier in an expression, such as a variable name.
    */
   typedef struct Identifier : Expr {
-    char* symbol; /**< The name of the identifier */
+    uint16_t symbol; /**< The interned symbol id of the name */
+
+    mutable uint8_t cachedDepth;    /**< The scopes walked to resolve the identifier the last time, `uncached` before */
+    mutable uint16_t cachedSlot;    /**< The position of the variable in the scope it was found in */
+    mutable uint16_t cachedShadows; /**< The shadow count of the environment the position was cached in */
+
+    static const uint8_t uncached = UINT8_MAX; /**< Marks an identifier that was never resolved */
 
     Identifier()
-      : Expr(NodeType::Identifier), symbol(nullptr) {}
+      : Expr(NodeType::Identifier), symbol(Symbols::noSymbol), cachedDepth(uncached), cachedSlot(0), cachedShadows(0) {}
 
     // Delete copy constructor and copy assignment operator
     Identifier(const Identifier&) = delete;
     Identifier& operator=(const Identifier&) = delete;
-
-    ~Identifier() {
-      delete[] symbol;
-    }
   } Identifier;
 
   /**
@@ -206,115 +304,52 @@ public:
    * Represents a numeric literal in the AST.
    */
   typedef struct NumericLiteral : Expr {
-    int num; /**< The value of the numeric literal */
+    int num;    /**< The value of the numeric literal, in Q16.16 representation if `fixed` is set */
+    bool fixed; /**< Whether the literal has a fractional part */
 
     NumericLiteral()
-      : Expr(NodeType::NumericLiteral), num(0) {}
+      : Expr(NodeType::NumericLiteral), num(0), fixed(false) {}
     // Delete copy constructor and copy assignment operator
     NumericLiteral(const NumericLiteral&) = delete;
     NumericLiteral& operator=(const NumericLiteral&) = delete;
     ~NumericLiteral() = default;
   } NumericLiteral;
 
+  /**
+   * @struct StringLiteral
+   * 
+   * Represents a string literal in the AST, its contents are stored in the constant pool of the program.
+   */
   typedef struct StringLiteral : Expr {
-    char* value;
-    char* raw;
+    const char* value; /**< The contents without the quotes, owned by the constant pool */
+    uint16_t constant; /**< The index of the contents in the constant pool */
 
     StringLiteral()
-      : Expr(NodeType::StringLiteral), value(nullptr), raw(nullptr) {}
-
-    StringLiteral(char* _raw)
-      : Expr(NodeType::StringLiteral) {
-      size_t rawStrLen = strlen(_raw);
-      size_t valueStrLen = rawStrLen - 2;  // minus the two quotes
-      raw = new char[rawStrLen + 1];
-      value = new char[valueStrLen + 1];
-      strcpy(raw, _raw);
-      strncpy(value, _raw + 1, valueStrLen);
-      raw[rawStrLen] = '\0';
-      value[valueStrLen] = '\0';
-    }
-
-    // Copy constructor
-    StringLiteral(const StringLiteral& other)
-      : Expr(NodeType::StringLiteral) {
-      if (other.raw) {
-        raw = new char[strlen(other.raw) + 1];
-        strcpy(raw, other.raw);
-      } else {
-        raw = nullptr;
-      }
-      if (other.value) {
-        value = new char[strlen(other.value) + 1];
-        strcpy(value, other.value);
-      } else {
-        value = nullptr;
-      }
-    }
-
-    // Move constructor
-    StringLiteral(StringLiteral&& other) noexcept
-      : Expr(NodeType::StringLiteral) {
-      raw = other.raw;
-      value = other.value;
-      other.raw = nullptr;
-      other.value = nullptr;
-    }
+      : Expr(NodeType::StringLiteral), value(nullptr), constant(0) {}
 
-    // Copy assignment operator
-    StringLiteral& operator=(const StringLiteral& other) {
-      if (this == &other) return *this;
-
-      delete[] raw;
-      delete[] value;
-
-      if (other.raw) {
-        raw = new char[strlen(other.raw) + 1];
-        strcpy(raw, other.raw);
-      } else {
-        raw = nullptr;
-      }
-      if (other.value) {
-        value = new char[strlen(other.value) + 1];
-        strcpy(value, other.value);
-      } else {
-        value = nullptr;
-      }
-
-      return *this;
-    }
-
-    // Move assignment operator
-    StringLiteral& operator=(StringLiteral&& other) noexcept {
-      if (this == &other) return *this;
-
-      delete[] raw;
-      delete[] value;
-
-      raw = other.raw;
-      value = other.value;
-      other.raw = nullptr;
-      other.value = nullptr;
-
-      return *this;
-    }
-
-    ~StringLiteral() {
-      delete[] value;
-      delete[] raw;
-    }
+    // Delete copy constructor and copy assignment operator
+    StringLiteral(const StringLiteral&) = delete;
+    StringLiteral& operator=(const StringLiteral&) = delete;
   } StringLiteral;
 
   /**
    * @struct ObjectLiteral
    * 
    * Represents a data structure of key/value pairs.
+   * The keys are stored in the shape shared with all objects created from this literal,
+   * the values are stored in slot order.
    */
   typedef struct ObjectLiteral : Expr {
-    std::map<String, std::unique_ptr<AstNodes::Expr>> properties;
+    Shape* shape;                                         /**< The property layout of the literal */
+    std::vector<std::unique_ptr<AstNodes::Expr>> values;  /**< The property values by slot, nullptr for `{ key }` */
 
     ObjectLiteral()
-      : Expr(NodeType::ObjectLiteral) {}
+      : Expr(NodeType::ObjectLiteral), shape(new Shape()) {}
+
+    ~ObjectLiteral() {
+      shape->release();
+    }
+
     // Delete copy constructor and copy assignment operator
     ObjectLiteral(const ObjectLiteral&) = delete;
     ObjectLiteral& operator=(const ObjectLiteral&) = delete;
@@ -368,9 +403,10 @@ public:
    */
   typedef struct BlockStmt : Stmt {
     std::vector<std::unique_ptr<Stmt>> body; /**< A list of statements within the block */
+    bool declaresVariables;                  /**< Whether a statement of the block declares a variable, only then it needs its own scope */
 
     BlockStmt()
-      : Stmt(NodeType::BlockStmt) {}
+      : Stmt(NodeType::BlockStmt), declaresVariables(false) {}
   } BlockStmt;
 
   /**
@@ -407,6 +443,25 @@ public:
     WhileStmt& operator=(const WhileStmt&) = delete;
   } WhileStmt;
 
+  /**
+   * @struct ForStmt
+   * 
+   * Represents a loop over the numbers of the range `start..end`, including `start` and excluding `end`.
+   * The loop variable is a constant of the loop scope, the interpreter counts it up in its slot.
+   */
+  typedef struct ForStmt : Stmt {
+    uint16_t ident;                        /**< The interned symbol id of the loop variable */
+    std::unique_ptr<AstNodes::Expr> start; /**< The first number of the range */
+    std::unique_ptr<AstNodes::Expr> end;   /**< The end of the range, evaluated once before the first iteration */
+    std::unique_ptr<BlockStmt> body;       /**< The body of the for loop */
+
+    ForStmt()
+      : Stmt(NodeType::ForStmt), ident(Symbols::noSymbol), start(nullptr), end(nullptr), body(nullptr) {}
+    // Delete copy constructor and copy assignment operator
+    ForStmt(const ForStmt&) = delete;
+    ForStmt& operator=(const ForStmt&) = delete;
+  } ForStmt;
+
   /**
    * @struct BreakStmt
    * 
@@ -417,6 +472,51 @@ public:
       : Stmt(NodeType::BreakStmt) {}
   } BreakStmt;
 
+  /**
+   * @struct ContinueStmt
+   * 
+   * Represents a continue statement, starting the next iteration of the innermost loop.
+   */
+  typedef struct ContinueStmt : Stmt {
+    ContinueStmt()
+      : Stmt(NodeType::ContinueStmt) {}
+  } ContinueStmt;
+
+  /**
+   * @struct FunctionDeclaration
+   * 
+   * Represents a user-defined function with its name, parameters and body.
+   * The body has no scope of its own, its variables are declared in the call frame next to the parameters.
+   */
+  typedef struct FunctionDeclaration : Stmt {
+    uint16_t name;                   /**< The interned symbol id of the function name */
+    std::vector<uint16_t> params;    /**< The interned symbol ids of the parameter names, in order */
+    std::unique_ptr<BlockStmt> body; /**< The statements executed by a call */
+
+    FunctionDeclaration()
+      : Stmt(NodeType::FunctionDeclaration), name(Symbols::noSymbol), body(nullptr) {}
+
+    // Delete copy constructor and copy assignment operator
+    FunctionDeclaration(const FunctionDeclaration&) = delete;
+    FunctionDeclaration& operator=(const FunctionDeclaration&) = delete;
+  } FunctionDeclaration;
+
+  /**
+   * @struct ReturnStmt
+   * 
+   * Represents a return statement, ending the innermost function call.
+   */
+  typedef struct ReturnStmt : Stmt {
+    std::unique_ptr<AstNodes::Expr> value; /**< The returned expression, nullptr returns null */
+
+    ReturnStmt()
+      : Stmt(NodeType::ReturnStmt), value(nullptr) {}
+
+    // Delete copy constructor and copy assignment operator
+    ReturnStmt(const ReturnStmt&) = delete;
+    ReturnStmt& operator=(const ReturnStmt&) = delete;
+  } ReturnStmt;
+
   static String nodeTypeToString(NodeType type) {
     return nodeTypeStrings.at(type);
   }
@@ -426,9 +526,14 @@ private:
     { NodeType::VarDeclaration, "VarDeclaration" },
     { NodeType::IfStmt, "IfStmt" },
     { NodeType::WhileStmt, "WhileStmt" },
+    { NodeType::ForStmt, "ForStmt" },
     { NodeType::BreakStmt, "BreakStmt" },
+    { NodeType::ContinueStmt, "ContinueStmt" },
     { NodeType::BlockStmt, "BlockStmt" },
+    { NodeType::FunctionDeclaration, "FunctionDeclaration" },
+    { NodeType::ReturnStmt, "ReturnStmt" },
     { NodeType::AssignmentExpr, "AssignmentExpr" },
+    { NodeType::UpdateExpr, "UpdateExpr" },
     { NodeType::CallExpr, "CallExpr" },
     { NodeType::MemberExpr, "MemberExpr" },
     { NodeType::NumericLiteral, "NumericLiteral" },
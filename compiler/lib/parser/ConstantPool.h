@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "Constants.h"
+#include "ErrorHandler.h"
+
+/**
+ * @class ConstantPool
+ * @brief The contents of the string literals of a program, every distinct string is stored once.
+ *
+ * The parser adds each string literal while parsing, literals with the same contents share one entry.
+ * The interpreter turns every entry into a runtime value once, when the program starts, so evaluating a literal
+ * only copies that value instead of allocating and copying the string again.
+ */
+class ConstantPool {
+public:
+  ConstantPool() {
+    strings.reserve(estimatedConstants);
+  }
+
+  ~ConstantPool() {
+    for (char* str : strings) {
+      delete[] str;
+    }
+  }
+
+  // Delete copy constructor and copy assignment operator
+  ConstantPool(const ConstantPool&) = delete;
+  ConstantPool& operator=(const ConstantPool&) = delete;
+
+  /**
+   * @brief Adds a string, only used while parsing.
+   * @param str The characters of the string, not necessarily terminated.
+   * @param len The length of the string.
+   * @return The index of the string, the existing index if the pool already holds the same contents.
+   * @throws ErrorHandler::restart if the program has more than `maxConstants` distinct strings.
+   */
+  uint16_t add(const char* str, size_t len) {
+    for (size_t i = 0; i < strings.size(); i++) {
+      if (strncmp(strings[i], str, len) == 0 && strings[i][len] == '\0') {
+        return i;
+      }
+    }
+
+    if (strings.size() >= maxConstants) {
+      ErrorHandler::restart("Too many different string literals");
+    }
+
+    char* copy = new char[len + 1];
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    strings.push_back(copy);
+    return strings.size() - 1;
+  }
+
+  /**
+   * @brief Returns the string stored at the given index, valid as long as the pool.
+   */
+  const char* at(uint16_t index) const {
+    return strings[index];
+  }
+
+  /**
+   * @brief Returns the number of distinct strings.
+   */
+  uint16_t size() const {
+    return strings.size();
+  }
+
+private:
+  std::vector<char*> strings; /**< The contents of the literals by index */
+};
@@ -21,7 +21,7 @@ AstNodes::Program* Parser::produceAST(char* code, size_t len) {
 
 std::unique_ptr<AstNodes::Stmt> Parser::parseStmt() {
   Serial.println("parseStmt");
-  Serial.println(at().value);
+  Serial.println(at().text());
   switch (at().type) {
     case Lexer::TokenType::Let:
     case Lexer::TokenType::Const:
@@ -33,9 +33,21 @@ std::unique_ptr<AstNodes::Stmt> Parser::parseStmt() {
     case Lexer::TokenType::While:
       Serial.println("Parsing while statement");
       return parseWhileStmt();
+    case Lexer::TokenType::For:
+      Serial.println("Parsing for statement");
+      return parseForStmt();
     case Lexer::TokenType::Break:
       Serial.println("Parsing break statement");
       return parseBreakStmt();
+    case Lexer::TokenType::Continue:
+      Serial.println("Parsing continue statement");
+      return parseContinueStmt();
+    case Lexer::TokenType::Fn:
+      Serial.println("Parsing function declaration");
+      return parseFunctionDeclaration();
+    case Lexer::TokenType::Return:
+      Serial.println("Parsing return statement");
+      return parseReturnStmt();
     default:
       Serial.println("Parsing expr");
       std::unique_ptr<AstNodes::Stmt> result = parseExpr();
@@ -51,10 +63,9 @@ std::unique_ptr<AstNodes::VarDeclaration> Parser::parseVarDeclaration() {
 
   std::unique_ptr<AstNodes::VarDeclaration> varDecl = std::make_unique<AstNodes::VarDeclaration>();
   varDecl->constant = isConstant;
-  varDecl->ident = varName.value;
-  varName.value = nullptr;
+  varDecl->ident = varName.symbol;
 
-  Serial.println(varDecl->ident);
+  Serial.println(Symbols::name(varDecl->ident));
 
   if (at().type == Lexer::TokenType::Semicolon) {
     eat();
@@ -108,13 +119,42 @@ std::unique_ptr<AstNodes::WhileStmt> Parser::parseWhileStmt() {
   if(!whileStmt->test) return nullptr;
   expect(Lexer::TokenType::CloseParen, "Expected ')' after while statement test");
 
+  pushTask();
   whileStmt->body = parseBlockStmt();
+  nestedTasks--;
 
   Serial.println("return parseWhileStmt");
 
   return whileStmt;
 }
 
+std::unique_ptr<AstNodes::ForStmt> Parser::parseForStmt() {
+  Serial.println("parseForStmt");
+  eat();  // consume 'for'
+  std::unique_ptr<AstNodes::ForStmt> forStmt = std::make_unique<AstNodes::ForStmt>();
+
+  expect(Lexer::TokenType::OpenParen, "Expected '(' after keyword 'for'");
+  forStmt->ident = expect(Lexer::TokenType::Identifier, "Expected loop variable after 'for ('").symbol;
+  expect(Lexer::TokenType::In, "Expected 'in' after loop variable");
+  forStmt->start = parseExpr();
+  if(!forStmt->start) return nullptr;
+  expect(Lexer::TokenType::Range, "Expected '..' between the bounds of the range");
+  forStmt->end = parseExpr();
+  if(!forStmt->end) return nullptr;
+  expect(Lexer::TokenType::CloseParen, "Expected ')' after for statement range");
+
+  // the loop variable gets a scope of its own
+  pushTask();
+  pushScope();
+  forStmt->body = parseBlockStmt();
+  nestedTasks--;
+  nestedScopes--;
+
+  Serial.println("return parseForStmt");
+
+  return forStmt;
+}
+
 std::unique_ptr<AstNodes::BreakStmt> Parser::parseBreakStmt() {
   Serial.println("parseBreakStmt");
   eat();  // consume 'break'
@@ -123,9 +163,79 @@ std::unique_ptr<AstNodes::BreakStmt> Parser::parseBreakStmt() {
   return breakStmt;
 }
 
-std::unique_ptr<AstNodes::BlockStmt> Parser::parseBlockStmt() {
+std::unique_ptr<AstNodes::ContinueStmt> Parser::parseContinueStmt() {
+  Serial.println("parseContinueStmt");
+  eat();  // consume 'continue'
+  std::unique_ptr<AstNodes::ContinueStmt> continueStmt = std::make_unique<AstNodes::ContinueStmt>();
+  expect(Lexer::TokenType::Semicolon, "Expected ';' after 'continue'");
+  return continueStmt;
+}
+
+std::unique_ptr<AstNodes::FunctionDeclaration> Parser::parseFunctionDeclaration() {
+  Serial.println("parseFunctionDeclaration");
+  eat();  // consume 'fn'
+  // calls resolve free variables from the global scope, so functions cannot capture the scope of a block
+  if (blockDepth > 0) {
+    ErrorHandler::restart("Functions may only be declared at the top level");
+  }
+  std::unique_ptr<AstNodes::FunctionDeclaration> function = std::make_unique<AstNodes::FunctionDeclaration>();
+  function->name = expect(Lexer::TokenType::Identifier, "Expected function name after keyword 'fn'").symbol;
+
+  expect(Lexer::TokenType::OpenParen, "Expected '(' after function name");
+  if (at().type != Lexer::TokenType::CloseParen) {
+    while (true) {
+      Lexer::Token param = expect(Lexer::TokenType::Identifier, "Expected parameter name");
+      // the parameters are declared in one call frame, so a repeated name could never be bound
+      if (std::find(function->params.begin(), function->params.end(), param.symbol) != function->params.end()) {
+        ErrorHandler::restart("Duplicate parameter \"", param.text(), "\" in function declaration");
+      }
+      function->params.push_back(param.symbol);
+
+      if (function->params.size() > maxFunctionArgs) {
+        ErrorHandler::reportError("Too many parameters in function declaration");
+        return nullptr;
+      }
+
+      if (at().type == Lexer::TokenType::Comma) {
+        eat();
+      } else {
+        break;
+      }
+    }
+  }
+  function->params.shrink_to_fit();
+  expect(Lexer::TokenType::CloseParen, "Expected ')' after function parameters");
+
+  // the call frame holding the parameters is the scope of the body as well
+  pushScope();
+  function->body = parseBlockStmt(false);
+  nestedScopes--;
+
+  Serial.println("return parseFunctionDeclaration");
+
+  return function;
+}
+
+std::unique_ptr<AstNodes::ReturnStmt> Parser::parseReturnStmt() {
+  Serial.println("parseReturnStmt");
+  eat();  // consume 'return'
+  std::unique_ptr<AstNodes::ReturnStmt> returnStmt = std::make_unique<AstNodes::ReturnStmt>();
+  if (at().type != Lexer::TokenType::Semicolon) {
+    returnStmt->value = parseExpr();
+    if (!returnStmt->value) return nullptr;
+  }
+  expect(Lexer::TokenType::Semicolon, "Expected ';' after return statement");
+  return returnStmt;
+}
+
+std::unique_ptr<AstNodes::BlockStmt> Parser::parseBlockStmt(bool ownsScope) {
   Serial.println("parseBlockStmt");
   expect(Lexer::TokenType::OpenBrace, "Expected block statement. Type '{' to start");
+  // the interpreter could not execute deeper blocks, so the parser does not recurse into them either
+  blockDepth++;
+  pushTask();
+  uint8_t outerPeak = peakScopes;
+  peakScopes = nestedScopes;
   std::unique_ptr<AstNodes::BlockStmt> blockStmt = std::make_unique<AstNodes::BlockStmt>();
   blockStmt->body.reserve(estimatedBlockStatements);
 
@@ -137,11 +247,28 @@ std::unique_ptr<AstNodes::BlockStmt> Parser::parseBlockStmt() {
       continue;
     }
 
+    if (ownsScope && stmt->kind == AstNodes::NodeType::VarDeclaration && !blockStmt->declaresVariables) {
+      blockStmt->declaresVariables = true;
+      // the scope is pushed when the block starts, so it encloses the statements parsed before as well
+      nestedScopes++;
+      if (++peakScopes > maxScopeDepth) {
+        ErrorHandler::restart("Scopes are nested too deeply");
+      }
+    }
+
     blockStmt->body.push_back(std::move(stmt));
   }
   blockStmt->body.shrink_to_fit();
 
   expect(Lexer::TokenType::CloseBrace, "Expected '}' to end block statement");
+  blockDepth--;
+  nestedTasks--;
+  if (blockStmt->declaresVariables) {
+    nestedScopes--;
+  }
+  if (outerPeak > peakScopes) {
+    peakScopes = outerPeak;
+  }
 
   Serial.println("return parseBlockStmt");
 
@@ -185,13 +312,14 @@ std::unique_ptr<AstNodes::Expr> Parser::parseRelationalExpr() {
 
   if (!left) return nullptr;
 
-  while (strcmp(at().value, "<") == 0 || strcmp(at().value, "<=") == 0 || strcmp(at().value, ">") == 0 || strcmp(at().value, ">=") == 0 || strcmp(at().value, "==") == 0 || strcmp(at().value, "!=") == 0) {
+  while (strcmp(at().text(), "<") == 0 || strcmp(at().text(), "<=") == 0 || strcmp(at().text(), ">") == 0 || strcmp(at().text(), ">=") == 0 || strcmp(at().text(), "==") == 0 || strcmp(at().text(), "!=") == 0) {
     Lexer::Token op = eat();
 
     std::unique_ptr<AstNodes::BinaryExpr> relationalExpr = std::make_unique<AstNodes::BinaryExpr>();
     relationalExpr->left = std::move(left);
     relationalExpr->right = parseRelationalExpr();
     relationalExpr->op = op.value;
+    relationalExpr->opcode = AstNodes::BinaryExpr::decode(op.value);
     op.value = nullptr;
 
     return relationalExpr;
@@ -210,16 +338,33 @@ std::unique_ptr<AstNodes::Expr> Parser::parseAssignmentExpr() {
 
   if (at().type == Lexer::TokenType::Equals) {
     eat();
-    if (left->kind != AstNodes::NodeType::Identifier) {
-      ErrorHandler::reportError("Expected variable name for assignment");
+    if (left->kind != AstNodes::NodeType::Identifier && left->kind != AstNodes::NodeType::MemberExpr) {
+      ErrorHandler::reportError("Expected variable name or member expression for assignment");
     }
     std::unique_ptr<AstNodes::AssignmentExpr> assignmentExpr = std::make_unique<AstNodes::AssignmentExpr>();
     assignmentExpr->assignee = std::move(left);
     assignmentExpr->value = parseAssignmentExpr();
+    if (!assignmentExpr->value) return nullptr;
 
     return assignmentExpr;
   }
 
+  if (at().type == Lexer::TokenType::CompoundAssignment || at().type == Lexer::TokenType::IncrementOperator) {
+    Lexer::Token op = eat();
+    if (left->kind != AstNodes::NodeType::Identifier && left->kind != AstNodes::NodeType::MemberExpr) {
+      ErrorHandler::reportError("Expected variable name or member expression for assignment");
+    }
+    std::unique_ptr<AstNodes::UpdateExpr> updateExpr = std::make_unique<AstNodes::UpdateExpr>();
+    updateExpr->target = std::move(left);
+    updateExpr->op = op.value[0] == '+' ? AstNodes::BinaryOp::Add : AstNodes::BinaryOp::Subtract;
+    if (op.type == Lexer::TokenType::CompoundAssignment) {
+      updateExpr->value = parseAssignmentExpr();
+      if (!updateExpr->value) return nullptr;
+    }
+
+    return updateExpr;
+  }
+
   Serial.println("return parseAssignmentExpr");
 
   return left;
@@ -238,20 +383,30 @@ std::unique_ptr<AstNodes::Expr> Parser::parseObjectExpr() {
   while (!endOfFile() && at().type != Lexer::TokenType::CloseBrace) {
     Lexer::Token keyToken = expect(Lexer::TokenType::Identifier, "Expected identifier for object key");
 
+    if (objectLiteral->shape->size() >= maxObjectProperties && objectLiteral->shape->slotOf(keyToken.symbol) == Shape::noSlot) {
+      ErrorHandler::reportError("Too many properties in object literal");
+      return nullptr;
+    }
+
+    uint8_t slot = objectLiteral->shape->addKey(keyToken.symbol);
+    if (slot == objectLiteral->values.size()) {
+      objectLiteral->values.push_back(nullptr);
+    }
+
     // options for { key, [...]} and { key }
     if (at().type == Lexer::TokenType::Comma || at().type == Lexer::TokenType::CloseBrace) {
       if (at().type == Lexer::TokenType::Comma) {
         eat();
       }
 
-      objectLiteral->properties[keyToken.value] = nullptr;
+      objectLiteral->values[slot] = nullptr;
     } else { // { key: value, [...]}
       expect(Lexer::TokenType::Colon, "Expected ':' or ',' after object key");
       std::unique_ptr<AstNodes::Expr> value = parseExpr();
       if(!value) {
         return nullptr;
       }
-      objectLiteral->properties[keyToken.value] = std::move(value);
+      objectLiteral->values[slot] = std::move(value);
 
       if (at().type != Lexer::TokenType::CloseBrace) {
         expect(Lexer::TokenType::Comma, "Expected ',' or '}' after object key");
@@ -306,7 +461,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseAdditiveExpr() {
   Serial.println("parseAdditiveExpr");
   std::unique_ptr<AstNodes::Expr> leftMost = parseMultiplicativeExpr();
 
-  while (strcmp(at().value, "+") == 0 || strcmp(at().value, "-") == 0) {
+  while (strcmp(at().text(), "+") == 0 || strcmp(at().text(), "-") == 0) {
     Lexer::Token op = eat();
 
     std::unique_ptr<AstNodes::BinaryExpr> binaryExpr = std::make_unique<AstNodes::BinaryExpr>();
@@ -314,6 +469,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseAdditiveExpr() {
     binaryExpr->left = std::move(leftMost);
     binaryExpr->right = parseMultiplicativeExpr();
     binaryExpr->op = op.value;
+    binaryExpr->opcode = AstNodes::BinaryExpr::decode(op.value);
     op.value = nullptr;
 
     leftMost = std::move(binaryExpr);
@@ -328,7 +484,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseMultiplicativeExpr() {
   Serial.println("parseMultiplicativeExpr");
   std::unique_ptr<AstNodes::Expr> leftMost = parseCallMemberExpr();
 
-  while (strcmp(at().value, "*") == 0 || strcmp(at().value, "/") == 0 || strcmp(at().value, "%") == 0) {
+  while (strcmp(at().text(), "*") == 0 || strcmp(at().text(), "/") == 0 || strcmp(at().text(), "%") == 0) {
     Lexer::Token op = eat();
 
     std::unique_ptr<AstNodes::BinaryExpr> binaryExpr = std::make_unique<AstNodes::BinaryExpr>();
@@ -336,6 +492,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseMultiplicativeExpr() {
     binaryExpr->left = std::move(leftMost);
     binaryExpr->right = parseCallMemberExpr();
     binaryExpr->op = op.value;
+    binaryExpr->opcode = AstNodes::BinaryExpr::decode(op.value);
     op.value = nullptr;
 
     leftMost = std::move(binaryExpr);
@@ -374,6 +531,11 @@ std::unique_ptr<AstNodes::CallExpr> Parser::parseCallExpr(std::unique_ptr<AstNod
       }
       callExpr->args.push_back(std::move(arg));
 
+      if (callExpr->args.size() > maxFunctionArgs) {
+        ErrorHandler::reportError("Too many arguments in function call");
+        return nullptr;
+      }
+
       if(at().type == Lexer::TokenType::Comma) {
         eat();
       } else {
@@ -404,7 +566,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseMemberExpr() {
       }
 
       Serial.print("Found dot, property: ");
-      Serial.println(static_cast<AstNodes::Identifier*>(property.get())->symbol);
+      Serial.println(Symbols::name(static_cast<AstNodes::Identifier*>(property.get())->symbol));
     } else if (op.type == Lexer::TokenType::OpenBracket) {
       computed = true;
       property = parseExpr();
@@ -421,7 +583,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parseMemberExpr() {
 
     if (memberExpr->property->kind == AstNodes::NodeType::Identifier) {
       Serial.print("MemberExpr property identifier: ");
-      Serial.println(static_cast<AstNodes::Identifier*>(memberExpr->property.get())->symbol);
+      Serial.println(Symbols::name(static_cast<AstNodes::Identifier*>(memberExpr->property.get())->symbol));
     }
 
     object = std::move(memberExpr);
@@ -440,11 +602,10 @@ std::unique_ptr<AstNodes::Expr> Parser::parsePrimaryExpr() {
 
         Lexer::Token identToken = eat();
 
-        identifier->symbol = identToken.value;
-        identToken.value = nullptr;
+        identifier->symbol = identToken.symbol;
 
         Serial.print("Found identifier ");
-        Serial.println(identifier->symbol);
+        Serial.println(Symbols::name(identifier->symbol));
 
         return identifier;
       }
@@ -452,16 +613,28 @@ std::unique_ptr<AstNodes::Expr> Parser::parsePrimaryExpr() {
       {
         std::unique_ptr<AstNodes::NumericLiteral> number = std::make_unique<AstNodes::NumericLiteral>();
 
-        number->num = strtof(eat().value, nullptr);
+        Lexer::Token token = eat();
+
+        // decimal literals become fixed-point numbers, both are parsed without floating point
+        if (strchr(token.value, '.') != nullptr) {
+          number->num = Fixed::parse(token.value);
+          number->fixed = true;
+        } else {
+          number->num = strtol(token.value, nullptr, 10);
+        }
 
         Serial.print("Found number ");
-        Serial.println(number->num);
+        Serial.println(token.value);
 
         return number;
       }
     case Lexer::TokenType::StringLiteral:
       {
-        std::unique_ptr<AstNodes::StringLiteral> str = std::make_unique<AstNodes::StringLiteral>(eat().value);
+        Lexer::Token token = eat();
+        std::unique_ptr<AstNodes::StringLiteral> str = std::make_unique<AstNodes::StringLiteral>();
+        // the token still holds the quotes, literals with the same contents share one pool entry
+        str->constant = program.constants.add(token.value + 1, strlen(token.value) - 2);
+        str->value = program.constants.at(str->constant);
 
         Serial.print("Found string ");
         Serial.println(str->value);
@@ -477,7 +650,7 @@ std::unique_ptr<AstNodes::Expr> Parser::parsePrimaryExpr() {
         return val;
       }
     default:
-      ErrorHandler::restart("Unexpected token \"", at().value, "\" found!");
+      ErrorHandler::restart("Unexpected token \"", at().text(), "\" found!");
       return std::make_unique<AstNodes::Identifier>();
   }
 }
@@ -501,7 +674,7 @@ Lexer::Token Parser::expect(Lexer::TokenType type, const char* errMsg) {
     ErrorHandler::restart(errMsg);
   }
   Serial.print("Found expected '");
-  Serial.print(prev.value);
+  Serial.print(prev.text());
   Serial.println("'");
   return prev;
 }
@@ -514,6 +687,21 @@ void Parser::push(std::unique_ptr<AstNodes::Stmt>&& stmt) {
   program.body.push_back(std::move(stmt));
 }
 
+void Parser::pushTask() {
+  if (++nestedTasks >= maxNestingDepth) {
+    ErrorHandler::restart("Blocks are nested too deeply");
+  }
+}
+
+void Parser::pushScope() {
+  if (++nestedScopes > peakScopes) {
+    peakScopes = nestedScopes;
+  }
+  if (peakScopes > maxScopeDepth) {
+    ErrorHandler::restart("Scopes are nested too deeply");
+  }
+}
+
 void Parser::synchronize() {
   while (!endOfFile()) {
     switch (at().type) {
@@ -524,7 +712,11 @@ void Parser::synchronize() {
       case Lexer::TokenType::Const:
       case Lexer::TokenType::If:
       case Lexer::TokenType::While:
+      case Lexer::TokenType::For:
       case Lexer::TokenType::Break:
+      case Lexer::TokenType::Continue:
+      case Lexer::TokenType::Fn:
+      case Lexer::TokenType::Return:
       case Lexer::TokenType::Else:
 
         return;
@@ -537,22 +729,28 @@ void Parser::synchronize() {
 // toString
 void Parser::toStringNumericLiteral(const AstNodes::NumericLiteral* numLit) {
   Serial.print("{\"type\":\"numericLiteral\",\"value\":\"");
-  Serial.print(numLit->num);
+  if (numLit->fixed) {
+    char buf[13];
+    Fixed::toString(numLit->num, buf, sizeof(buf));
+    Serial.print(buf);
+  } else {
+    Serial.print(numLit->num);
+  }
   Serial.print("\"}");
 }
 
 void Parser::toStringIdentifier(const AstNodes::Identifier* ident) {
   Serial.print("{\"type\":\"identifier\",\"symbol\":\"");
-  Serial.print(ident->symbol);
+  Serial.print(Symbols::name(ident->symbol));
   Serial.print("\"}");
 }
 
 void Parser::toStringStringLiteral(const AstNodes::StringLiteral* str) {
   Serial.print("{\"type\":\"stringLiteral\",\"value\":\"");
   Serial.print(str->value);
-  Serial.print("\",\"raw\":\"");
-  Serial.print(str->raw);
-  Serial.print("\"}");
+  Serial.print("\",\"raw\":\"\"");
+  Serial.print(str->value);
+  Serial.print("\"\"}");
 }
 
 void Parser::toStringBinaryExpr(const AstNodes::BinaryExpr* binaryExpr) {
@@ -583,7 +781,7 @@ void Parser::toStringVarDecl(const AstNodes::VarDeclaration* varDecl) {
   Serial.print("\"isConstant\":");
   Serial.print(varDecl->constant ? "\"true\"," : "\"false\",");
   Serial.print("\"identifier\":\"");
-  Serial.print(varDecl->ident);
+  Serial.print(Symbols::name(varDecl->ident));
   Serial.print("\",\"value\":");
   if (varDecl->value != nullptr) toString(varDecl->value.get());
   Serial.print("}");
@@ -624,10 +822,53 @@ void Parser::toStringWhileStmt(const AstNodes::WhileStmt* whileStmt) {
   Serial.print("}");
 }
 
+void Parser::toStringForStmt(const AstNodes::ForStmt* forStmt) {
+  Serial.print("{\"type\":\"forStmt\",\"identifier\":\"");
+  Serial.print(Symbols::name(forStmt->ident));
+  Serial.print("\",\"start\":");
+  toString(forStmt->start.get());
+  Serial.print(",\"end\":");
+  toString(forStmt->end.get());
+  Serial.print(",\"body\":");
+  toStringBlockStmt(forStmt->body.get());
+  Serial.print("}");
+}
+
 void Parser::toStringBreakStmt(const AstNodes::BreakStmt* breakStmt) {
   Serial.print("{\"type\":\"breakStmt\"}");
 }
 
+void Parser::toStringContinueStmt(const AstNodes::ContinueStmt* continueStmt) {
+  Serial.print("{\"type\":\"continueStmt\"}");
+}
+
+void Parser::toStringFunctionDeclaration(const AstNodes::FunctionDeclaration* function) {
+  Serial.print("{\"type\":\"functionDecl\",\"name\":\"");
+  Serial.print(Symbols::name(function->name));
+  Serial.print("\",\"params\":[");
+  for (size_t i = 0; i < function->params.size(); i++) {
+    Serial.print("\"");
+    Serial.print(Symbols::name(function->params[i]));
+    Serial.print("\"");
+    if (i + 1 < function->params.size()) {
+      Serial.print(",");
+    }
+  }
+  Serial.print("],\"body\":");
+  toStringBlockStmt(function->body.get());
+  Serial.print("}");
+}
+
+void Parser::toStringReturnStmt(const AstNodes::ReturnStmt* returnStmt) {
+  Serial.print("{\"type\":\"returnStmt\",\"value\":");
+  if (returnStmt->value != nullptr) {
+    toString(returnStmt->value.get());
+  } else {
+    Serial.print("null");
+  }
+  Serial.print("}");
+}
+
 void Parser::toStringAssignmentExpr(const AstNodes::AssignmentExpr* assignmentExpr) {
   Serial.print("{\"type\":\"assignmentExpr\",\"assignee\":");
   toString(assignmentExpr->assignee.get());
@@ -636,15 +877,29 @@ void Parser::toStringAssignmentExpr(const AstNodes::AssignmentExpr* assignmentEx
   Serial.print("}");
 }
 
+void Parser::toStringUpdateExpr(const AstNodes::UpdateExpr* updateExpr) {
+  Serial.print("{\"type\":\"updateExpr\",\"target\":");
+  toString(updateExpr->target.get());
+  Serial.print(",\"operator\":\"");
+  Serial.print(AstNodes::BinaryExpr::symbol(updateExpr->op));
+  Serial.print("\",\"value\":");
+  if (updateExpr->value != nullptr) {
+    toString(updateExpr->value.get());
+  } else {
+    Serial.print("null");
+  }
+  Serial.print("}");
+}
+
 void Parser::toStringObjectLiteral(const AstNodes::ObjectLiteral* objectLiteral) {
   Serial.print("{\"type\":\"objectLiteral\",\"properties\":{");
-  for (const auto& [key, value] : objectLiteral->properties) {
+  for (uint8_t slot = 0; slot < objectLiteral->shape->size(); slot++) {
     Serial.print("\"");
-    Serial.print(key);
+    Serial.print(Symbols::name(objectLiteral->shape->keyAt(slot)));
     Serial.print("\":");
-    toString(value.get());
+    toString(objectLiteral->values[slot].get());
 
-    if (key != objectLiteral->properties.rbegin()->first) {
+    if (slot != objectLiteral->shape->size() - 1) {
       Serial.print(",");
     }
   }
@@ -727,15 +982,30 @@ void Parser::toString(const AstNodes::Stmt* stmt) {
     case AstNodes::NodeType::WhileStmt:
       toStringWhileStmt(static_cast<const AstNodes::WhileStmt*>(stmt));
       break;
+    case AstNodes::NodeType::ForStmt:
+      toStringForStmt(static_cast<const AstNodes::ForStmt*>(stmt));
+      break;
     case AstNodes::NodeType::BreakStmt:
       toStringBreakStmt(static_cast<const AstNodes::BreakStmt*>(stmt));
       break;
+    case AstNodes::NodeType::ContinueStmt:
+      toStringContinueStmt(static_cast<const AstNodes::ContinueStmt*>(stmt));
+      break;
     case AstNodes::NodeType::BlockStmt:
       toStringBlockStmt(static_cast<const AstNodes::BlockStmt*>(stmt));
       break;
+    case AstNodes::NodeType::FunctionDeclaration:
+      toStringFunctionDeclaration(static_cast<const AstNodes::FunctionDeclaration*>(stmt));
+      break;
+    case AstNodes::NodeType::ReturnStmt:
+      toStringReturnStmt(static_cast<const AstNodes::ReturnStmt*>(stmt));
+      break;
     case AstNodes::NodeType::AssignmentExpr:
       toStringAssignmentExpr(static_cast<const AstNodes::AssignmentExpr*>(stmt));
       break;
+    case AstNodes::NodeType::UpdateExpr:
+      toStringUpdateExpr(static_cast<const AstNodes::UpdateExpr*>(stmt));
+      break;
     case AstNodes::NodeType::ObjectLiteral:
       toStringObjectLiteral(static_cast<const AstNodes::ObjectLiteral*>(stmt));
       break;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <vector>
@@ -7,6 +8,8 @@
 #include "Lexer.h"
 #include "AstNodes.h"
 #include "ErrorHandler.h"
+#include "Fixed.h"
+#include "Symbols.h"
 
 /**
  * @class Parser
@@ -16,7 +19,8 @@
  */
 class Parser {
 public:
-  Parser() {
+  Parser()
+    : blockDepth(0), nestedTasks(0), nestedScopes(0), peakScopes(0) {
     this->lexer = new Lexer();
   }
 
@@ -38,9 +42,16 @@ public:
    */
   void printAST(const AstNodes::Program* program);
 private:
-  AstNodes::Program program;       /**< The root program node of the AST */
+  AstNodes::Program program;       /**< The root program node of the AST, owns the declarations and the string
+                                        literals runtime values reference, so the parser must outlive them */
   Lexer* lexer;                    /**< The lexer used for tokenizing the input */
   std::queue<Lexer::Token> tokens; /**< A queue of tokens to be processed */
+  uint8_t blockDepth;              /**< The number of blocks currently being parsed */
+  uint8_t nestedTasks;             /**< The tasks the interpreter pushes for the statements currently being parsed,
+                                        without the program, bounded by `maxNestingDepth` */
+  uint8_t nestedScopes;            /**< The scopes the interpreter pushes for the statements currently being parsed,
+                                        bounded by `maxScopeDepth` */
+  uint8_t peakScopes;              /**< The most scopes needed by a statement of the innermost block parsed so far */
 
   /**
    * @brief Parses a statement from the token stream.
@@ -72,17 +83,47 @@ private:
    */
   std::unique_ptr<AstNodes::WhileStmt> parseWhileStmt();
 
+  /**
+   * @brief Parses a for statement over a range.
+   * 
+   * Example: 'for (i in 0..n) { ... }'.
+   * 
+   * @return A unique pointer to the parsed for statement.
+   */
+  std::unique_ptr<AstNodes::ForStmt> parseForStmt();
+
   /**
    * @brief Parses a break statement.
    * @return A unique pointer to the parsed break statement.
    */
   std::unique_ptr<AstNodes::BreakStmt> parseBreakStmt();
 
+  /**
+   * @brief Parses a continue statement.
+   * @return A unique pointer to the parsed continue statement.
+   */
+  std::unique_ptr<AstNodes::ContinueStmt> parseContinueStmt();
+
+  /**
+   * @brief Parses a function declaration.
+   * @return A unique pointer to the parsed function declaration.
+   * @throws ErrorHandler::restart if the function is not declared at the top level of the program.
+   */
+  std::unique_ptr<AstNodes::FunctionDeclaration> parseFunctionDeclaration();
+
+  /**
+   * @brief Parses a return statement.
+   * @return A unique pointer to the parsed return statement.
+   */
+  std::unique_ptr<AstNodes::ReturnStmt> parseReturnStmt();
+
   /**
    * @brief Parses a block statement.
+   * @param ownsScope Whether the declarations of the block need a scope of their own, false for function bodies.
    * @return A unique pointer to the parsed block statement.
+   * @throws ErrorHandler::restart if the interpreter could not nest the tasks or scopes of the block.
    */
-  std::unique_ptr<AstNodes::BlockStmt> parseBlockStmt();
+  std::unique_ptr<AstNodes::BlockStmt> parseBlockStmt(bool ownsScope = true);
 
   /**
    * @brief Parses a logical expression.
@@ -100,6 +141,9 @@ private:
 
   /**
    * @brief Parses an assignment expression.
+   * 
+   * Compound assignments ('a += b', 'a -= b') and increments ('a++', 'a--') are parsed here as well.
+   * 
    * @return A unique pointer to the parsed assignment expression.
    */
   std::unique_ptr<AstNodes::Expr> parseAssignmentExpr();
@@ -176,6 +220,18 @@ private:
    */
   void push(std::unique_ptr<AstNodes::Stmt>&& stmt);
 
+  /**
+   * @brief Accounts for a task the interpreter pushes for the statement being parsed, a block or a loop.
+   * @throws ErrorHandler::restart if the tasks together with the program are more than `maxNestingDepth`.
+   */
+  void pushTask();
+
+  /**
+   * @brief Accounts for a scope the interpreter pushes for the statement being parsed, a for loop or a call.
+   * @throws ErrorHandler::restart if the scopes are more than `maxScopeDepth`.
+   */
+  void pushScope();
+
   /**
    * @brief Synchronizes the parser by skipping tokens until a statement boundary is reached.
    */
@@ -212,8 +268,13 @@ private:
   void toStringBlockStmt(const AstNodes::BlockStmt* blockStmt);
   void toStringIfStmt(const AstNodes::IfStmt* ifStmt);
   void toStringWhileStmt(const AstNodes::WhileStmt* whileStmt);
+  void toStringForStmt(const AstNodes::ForStmt* forStmt);
   void toStringBreakStmt(const AstNodes::BreakStmt* breakStmt);
+  void toStringContinueStmt(const AstNodes::ContinueStmt* continueStmt);
+  void toStringFunctionDeclaration(const AstNodes::FunctionDeclaration* function);
+  void toStringReturnStmt(const AstNodes::ReturnStmt* returnStmt);
   void toStringAssignmentExpr(const AstNodes::AssignmentExpr* assignmentExpr);
+  void toStringUpdateExpr(const AstNodes::UpdateExpr* updateExpr);
   void toStringObjectLiteral(const AstNodes::ObjectLiteral* objectLiteral);
   void toStringArrayLiteral(const AstNodes::ArrayLiteral* arrayLiteral);
   void toStringCallExpr(const AstNodes::CallExpr* callExpr);
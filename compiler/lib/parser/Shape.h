@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+#include "Constants.h"
+#include "Symbols.h"
+
+/**
+ * @class Shape
+ * @brief The property layout of objects, maps the symbol ids of property names to slot indices.
+ *
+ * The parser builds one shape per object literal, every object created from that literal shares it
+ * and stores its property values in a flat array in slot order. Once parsing is done a shape is
+ * immutable, so the identity of a shape is enough to reuse a previously resolved slot.
+ *
+ * Shapes are reference counted, they are held by their object literal and by every object using them.
+ */
+class Shape {
+public:
+  Shape()
+    : refCount(1) {}
+
+  // Delete copy constructor and copy assignment operator
+  Shape(const Shape&) = delete;
+  Shape& operator=(const Shape&) = delete;
+
+  /**
+   * @brief Adds a property to the layout, only used while parsing the object literal.
+   * @param key The symbol id of the property name.
+   * @return The slot of the property, the existing slot if the key is already part of the shape.
+   */
+  uint8_t addKey(uint16_t key) {
+    uint8_t slot = slotOf(key);
+    if (slot != noSlot) {
+      return slot;
+    }
+
+    keys.push_back(key);
+    return keys.size() - 1;
+  }
+
+  uint8_t addKey(const char* key) {
+    return addKey(Symbols::intern(key));
+  }
+
+  /**
+   * @brief Looks up the slot of a property.
+   * @param key The symbol id of the property name.
+   * @return The slot of the property or `noSlot` if the shape has no such property.
+   */
+  uint8_t slotOf(uint16_t key) const {
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (keys[i] == key) {
+        return i;
+      }
+    }
+    return noSlot;
+  }
+
+  uint8_t slotOf(const char* key) const {
+    // names that were never interned cannot be a property
+    uint16_t symbol = Symbols::find(key);
+    return symbol == Symbols::noSymbol ? noSlot : slotOf(symbol);
+  }
+
+  /**
+   * @brief Returns the symbol id of the property name stored in the given slot.
+   */
+  uint16_t keyAt(uint8_t slot) const {
+    return keys[slot];
+  }
+
+  /**
+   * @brief Returns the number of properties.
+   */
+  uint8_t size() const {
+    return keys.size();
+  }
+
+  void retain() {
+    refCount++;
+  }
+
+  /**
+   * @brief Drops one reference, deletes the shape if it was the last one.
+   */
+  void release() {
+    if (--refCount == 0) {
+      delete this;
+    }
+  }
+
+  static const uint8_t noSlot = UINT8_MAX; /**< Returned by `slotOf` for unknown properties */
+
+private:
+  uint16_t refCount;        /**< The number of object literals and objects using this shape */
+  std::vector<uint16_t> keys;  /**< The symbol ids of the property names, indexed by slot */
+};
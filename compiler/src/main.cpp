@@ -8,6 +8,9 @@
 #include "BLEComm.h"
 #include "Parser.h"
 #include "Interpreter.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "Region.h"
 
 PadsComm *padsComm = PadsComm::getInstance();
 BLEComm *btComm = BLEComm::getInstance();
@@ -285,6 +288,8 @@ void loop() {
         }
       case phoneInput_interpret:
         {
+          // everything the game allocates at runtime is released at once when leaving this branch
+          Region::Scope region;
           Parser parser;
           Interpreter interpreter;
           Environment env;
@@ -337,10 +342,12 @@ void loop() {
               char *code_cstr = new char[currentInput.length() + 1];
               currentInput.toCharArray(code_cstr, currentInput.length() + 1, 0);
               AstNodes::Program *program = parser.produceAST(code_cstr, currentInput.length() + 1);
-              yield();
+              Scheduler::yieldNow();
               parser.printAST(program);
-              yield();
+              Scheduler::yieldNow();
+              Profiler::reset();
               interpreter.evaluate(program, &env);
+              Profiler::printStats("Interpreter profile");
 
               delete[] code_cstr;
 
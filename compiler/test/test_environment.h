@@ -7,70 +7,119 @@
 
 void test_environment_global_env() {
     Environment env;
-    std::unique_ptr<Values::RuntimeVal> result = env.lookupVar("true");
-    TEST_ASSERT_EQUAL(Values::ValueType::Boolean, result->type);
-    TEST_ASSERT_EQUAL(true, static_cast<Values::BooleanVal*>(result.get())->value);
+    Values::Value result = env.lookupVar("true");
+    TEST_ASSERT_EQUAL(Values::ValueType::Boolean, result.type);
+    TEST_ASSERT_EQUAL(true, result.boolean);
     result = env.lookupVar("null");
-    TEST_ASSERT_EQUAL(Values::ValueType::Null, result->type);
+    TEST_ASSERT_EQUAL(Values::ValueType::Null, result.type);
 }
 
 void test_environment_nativefn_random() {
     Environment env;
-    std::unique_ptr<Values::RuntimeVal> result = env.lookupVar("random");
-    TEST_ASSERT_EQUAL(Values::ValueType::NativeFn, result->type);
-    Values::FunctionCall rnd = static_cast<Values::NativeFnVal*>(result.get())->call;
+    Values::Value result = env.lookupVar("random");
+    TEST_ASSERT_EQUAL(Values::ValueType::NativeFn, result.type);
+    TEST_ASSERT_FALSE(result.isHeap());
+    TEST_ASSERT_EQUAL(Builtins::find("random"), result.builtin);
     
-    std::vector<std::unique_ptr<Values::RuntimeVal>> args;
-    args.push_back(std::make_unique<Values::NumberVal>(0));
-    args.push_back(std::make_unique<Values::NumberVal>(5));
-    result = rnd(args, &env);
-    TEST_ASSERT_GREATER_OR_EQUAL(0, static_cast<Values::NumberVal*>(result.get())->value);
-    TEST_ASSERT_LESS_THAN(5, static_cast<Values::NumberVal*>(result.get())->value);
+    Values::Value argBuffer[] = { Values::Value::makeNumber(0), Values::Value::makeNumber(5) };
+    Values::ArgSpan args = { argBuffer, 2, "random" };
+    result = result.call(args, &env);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, result.number);
+    TEST_ASSERT_LESS_THAN(5, result.number);
 }
 
 void test_environment_declare_var() {
     Environment env;
-    std::unique_ptr<Values::NumberVal> val = std::make_unique<Values::NumberVal>(42);
-    std::unique_ptr<Values::RuntimeVal> result = env.declareVar("x", std::move(val), false);
-    TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal*>(result.get())->value);
+    Values::Value val = Values::Value::makeNumber(42);
+    Values::Value result = env.declareVar("x", std::move(val), false);
+    TEST_ASSERT_EQUAL(42, result.number);
 }
 
 void test_environment_assign_var() {
     Environment env;
-    std::unique_ptr<Values::NumberVal> val = std::make_unique<Values::NumberVal>(42);
+    Values::Value val = Values::Value::makeNumber(42);
     env.declareVar("x", std::move(val), false);
-    auto newVal = std::make_unique<Values::NumberVal>(100);
-    std::unique_ptr<Values::RuntimeVal> result = env.assignVar("x", std::move(newVal));
-    TEST_ASSERT_EQUAL(100, static_cast<Values::NumberVal*>(result.get())->value);
+    Values::Value newVal = Values::Value::makeNumber(100);
+    Values::Value result = env.assignVar("x", std::move(newVal));
+    TEST_ASSERT_EQUAL(100, result.number);
 }
 
 void test_environment_lookup_var() {
     Environment env;
-    std::unique_ptr<Values::NumberVal> val = std::make_unique<Values::NumberVal>(42);
+    Values::Value val = Values::Value::makeNumber(42);
     env.declareVar("x", std::move(val), false);
-    std::unique_ptr<Values::RuntimeVal> result = env.lookupVar("x");
-    TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal*>(result.get())->value);
+    Values::Value result = env.lookupVar("x");
+    TEST_ASSERT_EQUAL(42, result.number);
 }
 
 void test_environment_resolve_var() {
     Environment parentEnv;
-    std::unique_ptr<Values::NumberVal> val = std::make_unique<Values::NumberVal>(42);
+    Values::Value val = Values::Value::makeNumber(42);
     parentEnv.declareVar("x", std::move(val), false);
 
     Environment childEnv(&parentEnv);
-    std::unique_ptr<Values::RuntimeVal> result = childEnv.lookupVar("x");
-    TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal*>(result.get())->value);
+    Values::Value result = childEnv.lookupVar("x");
+    TEST_ASSERT_EQUAL(42, result.number);
 }
 
 void test_environment_reassign_const_var() {
     Environment env;
-    std::unique_ptr<Values::NumberVal> val = std::make_unique<Values::NumberVal>(42);
+    Values::Value val = Values::Value::makeNumber(42);
     env.declareVar("x", std::move(val), true);
-    std::unique_ptr<Values::NumberVal> newVal = std::make_unique<Values::NumberVal>(100);
+    Values::Value newVal = Values::Value::makeNumber(100);
     // TEST_ASSERT_THROWS(env.assignVar("x", std::move(newVal)), ErrorHandler::restart);
 }
 
 void test_environment_var_not_found() {
     Environment env;
     // TEST_ASSERT_THROWS(env.lookupVar("y"), ErrorHandler::restart);
-}
\ No newline at end of file
+}
+void test_environment_move_and_borrow() {
+    Environment env;
+    Values::Value arr = Values::Value::makeArray();
+    env.declareVar("arr", std::move(arr), false);
+    TEST_ASSERT_EQUAL(Values::ValueType::Null, arr.type);
+
+    const Values::Value& first = env.lookupVar("arr");
+    const Values::Value& second = env.lookupVar("arr");
+    TEST_ASSERT_TRUE(&first == &second);
+    TEST_ASSERT_EQUAL(1, first.array->refCount);
+
+    const Values::Value& assigned = env.assignVar("arr", Values::Value::makeNumber(3));
+    TEST_ASSERT_TRUE(&assigned == &first);
+    TEST_ASSERT_EQUAL(3, first.number);
+}
+
+void test_environment_many_vars() {
+    Environment env;
+    Environment child(&env);
+    char name[8];
+    for (int i = 0; i < 40; i++) {
+        snprintf(name, sizeof(name), "v%d", i);
+        child.declareVar(name, Values::Value::makeNumber(i), i % 2 == 0);
+    }
+    for (int i = 0; i < 40; i++) {
+        snprintf(name, sizeof(name), "v%d", i);
+        TEST_ASSERT_EQUAL(i, child.lookupVar(name).number);
+    }
+    child.assignVar("v1", Values::Value::makeNumber(100));
+    TEST_ASSERT_EQUAL(100, child.lookupVar("v1").number);
+    TEST_ASSERT_TRUE(child.lookupVar("print").type == Values::ValueType::NativeFn);
+    TEST_ASSERT_EQUAL(Symbols::intern("v1"), Symbols::intern("v1"));
+}
+
+void test_environment_builtins_table() {
+    TEST_ASSERT_EQUAL(Builtins::notFound, Builtins::find("x"));
+    TEST_ASSERT_EQUAL(Values::ValueType::Boolean, Builtins::value(Builtins::find("false")).type);
+
+    Environment env;
+    Environment child(&env);
+    Bindings::Binding& binding = child.resolveBinding(Symbols::intern("print"));
+    TEST_ASSERT_TRUE(binding.isConst());
+    TEST_ASSERT_TRUE(&binding == &env.resolveBinding(Symbols::intern("print")));
+
+    // child scopes may still shadow builtins
+    child.declareVar("print", Values::Value::makeNumber(1), false);
+    TEST_ASSERT_EQUAL(1, child.lookupVar("print").number);
+    TEST_ASSERT_EQUAL(Values::ValueType::NativeFn, env.lookupVar("print").type);
+}
@@ -13,8 +13,8 @@ void test_interpreter_const_var_decl() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(42, val.number);
 }
 
 void test_interpreter_number_var_decl() {
@@ -25,8 +25,8 @@ void test_interpreter_number_var_decl() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(42, val.number);
 }
 
 void test_interpreter_string_var_decl() {
@@ -37,8 +37,8 @@ void test_interpreter_string_var_decl() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<Values::StringVal *>(val.get())->str);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL_STRING("hello", val.cstr());
 }
 
 void test_interpreter_object_var_decl() {
@@ -49,10 +49,10 @@ void test_interpreter_object_var_decl() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  Values::ObjectVal *obj = static_cast<Values::ObjectVal *>(val.get());
-  TEST_ASSERT_EQUAL_STRING("John", static_cast<Values::StringVal *>(obj->properties["name"].get())->str);
-  TEST_ASSERT_EQUAL(30, static_cast<Values::NumberVal *>(obj->properties["age"].get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  Values::ObjectVal *obj = val.object;
+  TEST_ASSERT_EQUAL_STRING("John", obj->property("name")->cstr());
+  TEST_ASSERT_EQUAL(30, obj->property("age")->number);
 }
 
 void test_interpreter_assignment_expr() {
@@ -63,8 +63,8 @@ void test_interpreter_assignment_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(100, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(100, val.number);
 }
 
 void test_interpreter_if_stmt() {
@@ -75,8 +75,8 @@ void test_interpreter_if_stmt() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(100, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(100, val.number);
 }
 
 void test_interpreter_if_else_stmt() {
@@ -87,8 +87,8 @@ void test_interpreter_if_else_stmt() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(200, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(200, val.number);
 }
 void test_interpreter_if_stmt_logical_expr() {
   char code[] = "let x = 42; if (x == 42 and x != 100) { x = 200; }";
@@ -98,8 +98,8 @@ void test_interpreter_if_stmt_logical_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(200, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(200, val.number);
 }
 void test_interpreter_if_stmt_relational_expr() {
   char code[] = "let x = 42; if (x > 40) { x = 200; }";
@@ -109,8 +109,8 @@ void test_interpreter_if_stmt_relational_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(200, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(200, val.number);
 }
 void test_interpreter_additive_expr() {
   char code[] = "let x = 42 + 100;";
@@ -120,8 +120,8 @@ void test_interpreter_additive_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(142, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(142, val.number);
 }
 void test_interpreter_multiplicative_expr() {
   char code[] = "let x = 42 * 100;";
@@ -131,8 +131,8 @@ void test_interpreter_multiplicative_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(4200, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(4200, val.number);
 }
 void test_interpreter_while_stmt() {
   char code[] = "let x = 0; while (x < 10) { x = x + 1; }";
@@ -142,8 +142,8 @@ void test_interpreter_while_stmt() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(10, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(10, val.number);
 }
 void test_interpreter_break_stmt() {
   char code[] = "let x = 0; while (x < 10) { x = x + 1; if (x == 5) { break; } }";
@@ -153,8 +153,8 @@ void test_interpreter_break_stmt() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(5, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(5, val.number);
 }
 void test_interpreter_call_expr() {
   char code[] = "let x = random(42);";
@@ -164,9 +164,9 @@ void test_interpreter_call_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(Values::ValueType::Number, val->type);
-  int rndVal = static_cast<Values::NumberVal *>(val.get())->value;
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Number, val.type);
+  int rndVal = val.number;
   TEST_ASSERT_GREATER_OR_EQUAL(0, rndVal);
   TEST_ASSERT_LESS_THAN(42, rndVal);
 }
@@ -179,8 +179,8 @@ void test_interpreter_obj_member_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL_STRING("John", static_cast<Values::StringVal *>(val.get())->str);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL_STRING("John", val.cstr());
 }
 
 void test_interpreter_obj_member_expr_computed() {
@@ -191,8 +191,8 @@ void test_interpreter_obj_member_expr_computed() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL_STRING("John", static_cast<Values::StringVal *>(val.get())->str);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL_STRING("John", val.cstr());
 }
 
 void test_interpreter_array_member_expr() {
@@ -203,8 +203,8 @@ void test_interpreter_array_member_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(2, static_cast<Values::NumberVal *>(val.get())->value);
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(2, val.number);
 }
 
 void test_interpreter_array_member_assignment_expr() {
@@ -215,6 +215,355 @@ void test_interpreter_array_member_assignment_expr() {
 
   AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
 
-  std::unique_ptr<Values::RuntimeVal> val = interpreter.evaluate(program, &env);
-  TEST_ASSERT_EQUAL(42, static_cast<Values::NumberVal *>(val.get())->value);
-}
\ No newline at end of file
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(42, val.number);
+}
+void test_interpreter_array_copy_on_write() {
+  char code[] = "let x = [1, 2, 3]; let y = x; y[0] = 42; let z = x[0];";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(1, val.number);
+  TEST_ASSERT_EQUAL(42, env.lookupVar("y").array->get(0).number);
+}
+
+void test_interpreter_nested_member_assignment_expr() {
+  char code[] = "let x = [{count: 1}, {count: 2}]; let i = 1; x[i].count = 42; let y = x[1].count;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(42, val.number);
+  TEST_ASSERT_EQUAL(1, env.lookupVar("x").array->get(0).object->property("count")->number);
+}
+
+void test_interpreter_obj_member_expr_cached_slot() {
+  char code[] = "let x = {name: \"John\", age: 30}; let y = x.age;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(30, val.number);
+
+  AstNodes::VarDeclaration *varDecl = static_cast<AstNodes::VarDeclaration *>(program->body[1].get());
+  AstNodes::MemberExpr *member = static_cast<AstNodes::MemberExpr *>(varDecl->value.get());
+  TEST_ASSERT_TRUE(member->cachedShape == env.lookupVar("x").object->shape);
+  TEST_ASSERT_EQUAL(1, member->cachedSlot);
+}
+
+void test_interpreter_packed_arrays() {
+  char code[] = "let x = [440, 880, 1760]; let y = [true, false, true]; let z = [\"a\", \"b\"]; let w = y[1];";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Boolean, val.type);
+  TEST_ASSERT_FALSE(val.boolean);
+  TEST_ASSERT_EQUAL(Values::ElementKind::Int32, env.lookupVar("x").array->kind);
+  TEST_ASSERT_EQUAL(Values::ElementKind::Bits, env.lookupVar("y").array->kind);
+  TEST_ASSERT_EQUAL(Values::ElementKind::Generic, env.lookupVar("z").array->kind);
+}
+
+void test_interpreter_packed_array_generic_fallback() {
+  char code[] = "let x = [1, 2, 3]; x[0] = 42; let y = x[0]; x[1] = \"two\";";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  interpreter.evaluate(program, &env);
+  Values::Value x = env.lookupVar("x");
+  TEST_ASSERT_EQUAL(42, env.lookupVar("y").number);
+  TEST_ASSERT_EQUAL(Values::ElementKind::Generic, x.array->kind);
+  TEST_ASSERT_EQUAL(42, x.array->get(0).number);
+  Values::Value two = x.array->get(1);
+  TEST_ASSERT_EQUAL_STRING("two", two.cstr());
+  TEST_ASSERT_EQUAL(3, x.array->get(2).number);
+}
+
+void test_interpreter_fixed_arithmetic() {
+  char code[] = "let tempo = 1.5 * 4; let avg = 7 / 2.0; let slower = tempo > 5; let neg = -0.25 + 1;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Fixed, val.type);
+  TEST_ASSERT_EQUAL(Fixed::parse("0.75"), val.fixed);
+  TEST_ASSERT_EQUAL(Fixed::fromInt(6), env.lookupVar("tempo").fixed);
+  TEST_ASSERT_EQUAL(Fixed::one * 7 / 2, env.lookupVar("avg").fixed);
+  TEST_ASSERT_TRUE(env.lookupVar("slower").boolean);
+}
+
+void test_interpreter_fixed_large_ints() {
+  char code[] = "let above = 40000 > 1.5; let below = 1.5 < -40000; let half = 40000 * 0.5; let neg = 40000 * -0.5; let q = 50000 / 2.5;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  // integers outside of the fixed-point range are compared exactly and only the results have to fit
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_TRUE(env.lookupVar("above").boolean);
+  TEST_ASSERT_FALSE(env.lookupVar("below").boolean);
+  TEST_ASSERT_EQUAL(Fixed::fromInt(20000), env.lookupVar("half").fixed);
+  TEST_ASSERT_EQUAL(Fixed::fromInt(-20000), env.lookupVar("neg").fixed);
+  TEST_ASSERT_EQUAL(Fixed::fromInt(20000), env.lookupVar("q").fixed);
+}
+
+void test_interpreter_string_concat() {
+  char code[] = "let msg = \"Pad \"; let i = 0; while (i < 3) { msg = msg + \"ok \"; i = i + 1; } let same = msg == \"Pad ok ok ok \";";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_TRUE(val.boolean);
+  Values::Value msg = env.lookupVar("msg");
+  TEST_ASSERT_EQUAL_STRING("Pad ok ok ok ", msg.cstr());
+}
+
+void test_interpreter_block_scopes() {
+  char code[] = "let x = 0; let s = 0; while (x < 3) { let y = x * 2; s = s + y; x = x + 1; } if (s == 6) { s = 7; } let z = s;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+  TEST_ASSERT_TRUE(static_cast<AstNodes::WhileStmt*>(program->body[2].get())->body->declaresVariables);
+  TEST_ASSERT_FALSE(static_cast<AstNodes::IfStmt*>(program->body[3].get())->consequent->declaresVariables);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(7, val.number);
+}
+
+void test_interpreter_identifier_cache() {
+  char code[] = "let x = 1; let s = 0; let i = 0; while (i < 2) { s = s + x; let x = 10; s = s + x; i = i + 1; } while (i < 5) { i = i + 1; } let r = s;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Profiler::reset();
+  Values::Value val = interpreter.evaluate(program, &env);
+  // the shadowing declaration must not leave the outer x cached for the inner one
+  TEST_ASSERT_EQUAL(22, val.number);
+  TEST_ASSERT_GREATER_THAN(0, Profiler::get(Profiler::Counter::IdentifierCacheHit));
+  TEST_ASSERT_GREATER_THAN(0, Profiler::get(Profiler::Counter::IdentifierCacheMiss));
+}
+
+void test_interpreter_identifier_cache_shadowing() {
+  char code[] = "let a = 0; let y = 0; let s = 0; fn f(a) { return a; } let k = 0; while (k < 100) { let y = k; s = s + f(y); k = k + 1; } let r = s;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Profiler::reset();
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(4950, val.number);
+  // shadowing the global a and y in every call and iteration only checks the scopes in between
+  TEST_ASSERT_LESS_THAN(20, Profiler::get(Profiler::Counter::IdentifierCacheMiss));
+  TEST_ASSERT_GREATER_THAN(600, Profiler::get(Profiler::Counter::IdentifierCacheHit));
+}
+
+void test_interpreter_budgeted_yield() {
+  char code[] = "let i = 0; while (i < 2000) { i = i + 1; } let r = i;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Profiler::reset();
+  unsigned long start = millis();
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(2000, val.number);
+  // at most one yield per budget, instead of one per evaluated node
+  TEST_ASSERT_LESS_OR_EQUAL((millis() - start) * 1000 / yieldBudgetMicros + 1, Profiler::get(Profiler::Counter::SchedulerYield));
+}
+
+void test_interpreter_short_circuit() {
+  char code[] = "let x = 0; let a = false and (x = 1) == 1; let b = true or (x = 2) == 2; let c = true and (x = 3) == 3; x;";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Values::Value val = interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(3, val.number);
+  TEST_ASSERT_FALSE(env.lookupVar("a").boolean);
+  TEST_ASSERT_TRUE(env.lookupVar("b").boolean);
+  TEST_ASSERT_TRUE(env.lookupVar("c").boolean);
+}
+
+void test_interpreter_deep_nesting() {
+  // 15 nested loops, each running once
+  char code[512] = "let x = 0;";
+  for (int i = 0; i < 15; i++) {
+    snprintf(code + strlen(code), sizeof(code) - strlen(code), " while (x == %d) { x = x + 1;", i);
+  }
+  for (int i = 0; i < 15; i++) {
+    strcat(code, " }");
+  }
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, strlen(code));
+
+  Profiler::reset();
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(15, env.lookupVar("x").number);
+  // the program and every loop with its body block
+  TEST_ASSERT_EQUAL(31, Profiler::get(Profiler::Counter::NestingDepth));
+}
+
+void test_interpreter_deep_scopes() {
+  // the deepest for loops the parser accepts, each one with a scope for its variable and one for its body
+  char code[512] = "let total = 0;";
+  for (int i = 0; i < maxScopeDepth / 2; i++) {
+    snprintf(code + strlen(code), sizeof(code) - strlen(code), " for (i%d in 0..2) { let v%d = i%d;", i, i, i);
+  }
+  strcat(code, " total = total + 1;");
+  for (int i = 0; i < maxScopeDepth / 2; i++) {
+    strcat(code, " }");
+  }
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, strlen(code));
+
+  Profiler::reset();
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(1 << (maxScopeDepth / 2), env.lookupVar("total").number);
+  // the program and every loop with its body block
+  TEST_ASSERT_EQUAL(1 + maxScopeDepth, Profiler::get(Profiler::Counter::NestingDepth));
+}
+
+void test_interpreter_user_functions() {
+  char code[] = "fn fact(n) { if (n < 2) { return 1; } return n * fact(n - 1); }"
+                " fn firstAbove(limit) { let i = 0; while (true) { i = i + 1; if (i * i > limit) { return i; } } }"
+                " fn noop() { 1; }"
+                " let a = fact(5); let b = firstAbove(20); let c = noop();";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Profiler::reset();
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(120, env.lookupVar("a").number);
+  // returning from inside a loop ends the loop and the call
+  TEST_ASSERT_EQUAL(5, env.lookupVar("b").number);
+  TEST_ASSERT_EQUAL(Values::ValueType::Null, env.lookupVar("c").type);
+  TEST_ASSERT_EQUAL(5, Profiler::get(Profiler::Counter::CallDepth));
+  TEST_ASSERT_EQUAL(Values::ValueType::Function, env.lookupVar("fact").type);
+}
+
+void test_interpreter_for_range_and_updates() {
+  char code[] = "let s = 0; for (i in 0..5) { s += i; } for (j in 0..10) { if (j == 3) { break; } s++; }"
+                " let n = 10; n -= 3; n++; n--; n++;"
+                " let a = [1, 2, 3]; a[1] += 5; let o = { x: 1 }; o.x++; let t = \"a\"; t += \"b\";";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(13, env.lookupVar("s").number);
+  TEST_ASSERT_EQUAL(8, env.lookupVar("n").number);
+  TEST_ASSERT_EQUAL(7, env.lookupVar("a").array->get(1).number);
+  TEST_ASSERT_EQUAL(1, env.lookupVar("o").object->shape->size());
+  TEST_ASSERT_EQUAL(2, env.lookupVar("o").object->slots[0].number);
+  TEST_ASSERT_EQUAL_STRING("ab", env.lookupVar("t").cstr());
+}
+
+void test_interpreter_postfix_update_value() {
+  char code[] = "let x = 1; let y = x++; let z = x--; let a = [5]; let b = a[0]++; let o = { v: 3 }; let c = o.v--; let d = (x += 2);";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  interpreter.evaluate(program, &env);
+  // postfix updates evaluate to the old value, compound assignments to the new one
+  TEST_ASSERT_EQUAL(1, env.lookupVar("y").number);
+  TEST_ASSERT_EQUAL(2, env.lookupVar("z").number);
+  TEST_ASSERT_EQUAL(3, env.lookupVar("x").number);
+  TEST_ASSERT_EQUAL(5, env.lookupVar("b").number);
+  TEST_ASSERT_EQUAL(6, env.lookupVar("a").array->get(0).number);
+  TEST_ASSERT_EQUAL(3, env.lookupVar("c").number);
+  TEST_ASSERT_EQUAL(2, env.lookupVar("o").object->slots[0].number);
+  TEST_ASSERT_EQUAL(3, env.lookupVar("d").number);
+}
+
+void test_interpreter_continue_stmt() {
+  char code[] = "let s = 0; for (i in 0..6) { if (i % 2 == 0) { continue; } s += i; }"
+                " let j = 0; while (j < 5) { j++; if (j == 2) { continue; } s += 10; }"
+                " fn firstOdd(n) { for (k in n..100) { if (k % 2 == 0) { continue; } return k; } }"
+                " let f = firstOdd(4);";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(49, env.lookupVar("s").number);
+  TEST_ASSERT_EQUAL(5, env.lookupVar("f").number);
+}
+
+void test_interpreter_quickening() {
+  char code[] = "fn twice(x) { return x + x; } let a = [3, 4, 5]; let s = 0;"
+                " for (i in 0..3) { s += twice(a[i]); } let t = twice(\"ab\");";
+  Parser parser;
+  Environment env;
+  Interpreter interpreter;
+
+  AstNodes::Program *program = parser.produceAST(code, sizeof(code) - 1);
+
+  Profiler::reset();
+  interpreter.evaluate(program, &env);
+  TEST_ASSERT_EQUAL(24, env.lookupVar("s").number);
+  TEST_ASSERT_EQUAL_STRING("abab", env.lookupVar("t").cstr());
+
+  const AstNodes::FunctionDeclaration* twice = static_cast<const AstNodes::FunctionDeclaration*>(program->body[0].get());
+  const AstNodes::ReturnStmt* returnStmt = static_cast<const AstNodes::ReturnStmt*>(twice->body->body[0].get());
+  const AstNodes::BinaryExpr* sum = static_cast<const AstNodes::BinaryExpr*>(returnStmt->value.get());
+  // specialized by the numbers of the loop, the strings made it fall back
+  TEST_ASSERT_TRUE(sum->specialization == AstNodes::Specialization::Generic);
+  TEST_ASSERT_EQUAL(1, Profiler::get(Profiler::Counter::Deoptimization));
+
+  const AstNodes::ForStmt* loop = static_cast<const AstNodes::ForStmt*>(program->body[3].get());
+  const AstNodes::UpdateExpr* update = static_cast<const AstNodes::UpdateExpr*>(loop->body->body[0].get());
+  const AstNodes::CallExpr* call = static_cast<const AstNodes::CallExpr*>(update->value.get());
+  TEST_ASSERT_TRUE(call->specialization == AstNodes::Specialization::FunctionCall);
+  TEST_ASSERT_TRUE(static_cast<const AstNodes::MemberExpr*>(call->args[0].get())->specialization == AstNodes::Specialization::ArrayIndex);
+}
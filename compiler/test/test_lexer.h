@@ -10,22 +10,22 @@ void test_lexer_single_tokens() {
   std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
   TEST_ASSERT_EQUAL_INT(7, tokens.size());
   TEST_ASSERT_EQUAL(Lexer::TokenType::OpenBrace, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("{", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("{", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::CloseBrace, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("}", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("}", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::OpenParen, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("(", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("(", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::CloseParen, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING(")", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING(")", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::OpenBracket, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("[", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("[", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::CloseBracket, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("]", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("]", tokens.front().text());
   TEST_ASSERT_EQUAL(Lexer::TokenType::EndOfFile, tokens.back().type);
 }
 
@@ -34,34 +34,50 @@ void test_lexer_numbers() {
   std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
   TEST_ASSERT_EQUAL(3, tokens.size());
   TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("123", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("123", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("4567", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("4567", tokens.front().text());
   TEST_ASSERT_EQUAL(Lexer::TokenType::EndOfFile, tokens.back().type);
 }
 
+void test_lexer_decimal_numbers() {
+  char code[] = "1.25 -0.5 3.x";
+  std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
+  TEST_ASSERT_EQUAL(6, tokens.size());
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("1.25", tokens.front().text());
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("-0.5", tokens.front().text());
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("3", tokens.front().text());
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Dot, tokens.front().type);
+}
+
 void test_lexer_keywords() {
   char code[] = "let const if else while break";
   std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
   TEST_ASSERT_EQUAL(7, tokens.size());
   TEST_ASSERT_EQUAL(Lexer::TokenType::Let, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("let", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("let", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Const, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("const", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("const", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::If, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("if", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("if", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Else, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("else", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("else", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::While, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("while", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("while", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Break, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("break", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("break", tokens.front().text());
   TEST_ASSERT_EQUAL(Lexer::TokenType::EndOfFile, tokens.back().type);
 }
 
@@ -70,19 +86,19 @@ void test_lexer_operators() {
   std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
   TEST_ASSERT_EQUAL(6, tokens.size());
   TEST_ASSERT_EQUAL(Lexer::TokenType::ArithmeticOperator, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("+", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("+", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::ArithmeticOperator, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("-", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("-", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::ArithmeticOperator, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("*", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("*", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::ArithmeticOperator, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("/", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("/", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::ArithmeticOperator, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("%", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("%", tokens.front().text());
   TEST_ASSERT_EQUAL(Lexer::TokenType::EndOfFile, tokens.back().type);
 }
 
@@ -91,15 +107,48 @@ void test_lexer_identifiers() {
   std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
   TEST_ASSERT_EQUAL(5, tokens.size());
   TEST_ASSERT_EQUAL(Lexer::TokenType::Identifier, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("var1", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("var1", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Identifier, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("myVariable", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("myVariable", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Identifier, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("another_One", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("another_One", tokens.front().text());
   tokens.pop();
   TEST_ASSERT_EQUAL(Lexer::TokenType::Identifier, tokens.front().type);
-  TEST_ASSERT_EQUAL_STRING("test123", tokens.front().value);
+  TEST_ASSERT_EQUAL_STRING("test123", tokens.front().text());
   TEST_ASSERT_EQUAL(Lexer::TokenType::EndOfFile, tokens.back().type);
 }
+
+void test_lexer_interned_identifiers() {
+  char code[] = "count + count";
+  std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
+  uint16_t first = tokens.front().symbol;
+  TEST_ASSERT_NULL(tokens.front().value);
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Symbols::noSymbol, tokens.front().symbol);
+  tokens.pop();
+  TEST_ASSERT_EQUAL(first, tokens.front().symbol);
+  TEST_ASSERT_EQUAL(first, Symbols::find("count"));
+  TEST_ASSERT_EQUAL_STRING("count", Symbols::name(first));
+}
+
+void test_lexer_update_and_range_operators() {
+  char code[] = "i += 2; i--; 0..n";
+  std::queue<Lexer::Token> tokens = lexer.tokenize(code, sizeof(code));
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::CompoundAssignment, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("+=", tokens.front().value);
+  tokens.pop();
+  tokens.pop();
+  tokens.pop();
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::IncrementOperator, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("--", tokens.front().value);
+  tokens.pop();
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Number, tokens.front().type);
+  TEST_ASSERT_EQUAL_STRING("0", tokens.front().value);
+  tokens.pop();
+  TEST_ASSERT_EQUAL(Lexer::TokenType::Range, tokens.front().type);
+}
@@ -5,6 +5,7 @@
 #include "test_parser.h"
 #include "test_values.h"
 #include "test_environment.h"
+#include "test_region.h"
 #include "test_nativefn.h"
 #include "test_interpreter.h"
 
@@ -17,9 +18,12 @@ void setup() {
   // Lexer tests
   RUN_TEST(test_lexer_single_tokens);
   RUN_TEST(test_lexer_numbers);
+  RUN_TEST(test_lexer_decimal_numbers);
   RUN_TEST(test_lexer_keywords);
   RUN_TEST(test_lexer_operators);
   RUN_TEST(test_lexer_identifiers);
+  RUN_TEST(test_lexer_interned_identifiers);
+  RUN_TEST(test_lexer_update_and_range_operators);
 
   // Parser tests
   RUN_TEST(test_parser_const_var_decl);
@@ -44,25 +48,34 @@ void setup() {
   RUN_TEST(test_parser_call_expr_args);
   RUN_TEST(test_parser_member_expr);
   RUN_TEST(test_parser_member_expr_computed);
+  RUN_TEST(test_parser_function_declaration);
+  RUN_TEST(test_parser_constant_pool);
 
   // Values tests
   RUN_TEST(test_values_null_constructor);
 
-  RUN_TEST(test_values_boolean_default_constructor);
-  RUN_TEST(test_values_boolean_parameterized_constructor);
-
-  RUN_TEST(test_values_number_default_constructor);
-  RUN_TEST(test_values_number_parameterized_constructor);
+  RUN_TEST(test_values_boolean_constructor);
+  RUN_TEST(test_values_number_constructor);
+  RUN_TEST(test_values_value_size);
 
   RUN_TEST(test_values_string_default_constructor);
   RUN_TEST(test_values_string_parameterized_constructor);
   RUN_TEST(test_values_string_copy_constructor);
   RUN_TEST(test_values_string_move_constructor);
+  RUN_TEST(test_values_string_inline);
+  RUN_TEST(test_values_string_immortal);
+  RUN_TEST(test_values_string_rope);
 
   RUN_TEST(test_values_object_default_constructor);
   RUN_TEST(test_values_object_insertion);
   RUN_TEST(test_values_object_move_constructor);
   RUN_TEST(test_values_object_clone);
+  RUN_TEST(test_values_array_shared_copy);
+  RUN_TEST(test_values_array_copy_on_write);
+  RUN_TEST(test_values_array_packing);
+  RUN_TEST(test_values_native_closure);
+  RUN_TEST(test_values_fixed_conversion);
+  RUN_TEST(test_values_fixed_range);
 
   // Environment tests
   RUN_TEST(test_environment_global_env);
@@ -71,13 +84,23 @@ void setup() {
   RUN_TEST(test_environment_assign_var);
   RUN_TEST(test_environment_lookup_var);
   RUN_TEST(test_environment_resolve_var);
+  RUN_TEST(test_environment_move_and_borrow);
+  RUN_TEST(test_environment_many_vars);
+  RUN_TEST(test_environment_builtins_table);
   // RUN_TEST(test_environment_reassign_const_var);
   // RUN_TEST(test_environment_var_not_found);
 
+  // Region tests
+  RUN_TEST(test_region_recycles_blocks);
+  RUN_TEST(test_region_heap_fallback);
+  RUN_TEST(test_region_values);
+  RUN_TEST(test_region_buffers);
+
   // NativeFunctions tests
   RUN_TEST(test_nativefn_print);
   RUN_TEST(test_nativefn_rnd_onearg);
   RUN_TEST(test_nativefn_rnd_twoargs);
+  RUN_TEST(test_nativefn_bind_optional_arg);
 
   // Interpreter tests
   RUN_TEST(test_interpreter_const_var_decl);
@@ -100,8 +123,28 @@ void setup() {
   RUN_TEST(test_interpreter_call_expr);
   RUN_TEST(test_interpreter_obj_member_expr);
   RUN_TEST(test_interpreter_obj_member_expr_computed);
+  RUN_TEST(test_interpreter_obj_member_expr_cached_slot);
   RUN_TEST(test_interpreter_array_member_expr);
   RUN_TEST(test_interpreter_array_member_assignment_expr);
+  RUN_TEST(test_interpreter_array_copy_on_write);
+  RUN_TEST(test_interpreter_nested_member_assignment_expr);
+  RUN_TEST(test_interpreter_packed_arrays);
+  RUN_TEST(test_interpreter_packed_array_generic_fallback);
+  RUN_TEST(test_interpreter_fixed_arithmetic);
+  RUN_TEST(test_interpreter_fixed_large_ints);
+  RUN_TEST(test_interpreter_string_concat);
+  RUN_TEST(test_interpreter_block_scopes);
+  RUN_TEST(test_interpreter_identifier_cache);
+  RUN_TEST(test_interpreter_identifier_cache_shadowing);
+  RUN_TEST(test_interpreter_budgeted_yield);
+  RUN_TEST(test_interpreter_short_circuit);
+  RUN_TEST(test_interpreter_deep_nesting);
+  RUN_TEST(test_interpreter_deep_scopes);
+  RUN_TEST(test_interpreter_user_functions);
+  RUN_TEST(test_interpreter_for_range_and_updates);
+  RUN_TEST(test_interpreter_postfix_update_value);
+  RUN_TEST(test_interpreter_continue_stmt);
+  RUN_TEST(test_interpreter_quickening);
 
   UNITY_END();
 }
@@ -1,38 +1,52 @@
 #pragma once
 
-#include <memory>
-#include <vector>
 #include "interpreter/Values.h"
 #include "interpreter/Environment.h"
 #include "interpreter/NativeFunctions.h"
+#include "interpreter/NativeBinding.h"
 
 void test_nativefn_print() {
-  std::vector<std::unique_ptr<Values::RuntimeVal>> args;
-  args.push_back(std::make_unique<Values::NumberVal>(5));
+  Values::Value argBuffer[] = { Values::Value::makeNumber(5) };
+  Values::ArgSpan args = { argBuffer, 1, "print" };
   Environment env;
-  std::unique_ptr<Values::RuntimeVal> result = NativeFunctions::print(args, &env);
-  TEST_ASSERT_EQUAL(Values::ValueType::Null, result->type);
+  Values::Value result = NativeBinding::bindNative<&NativeFunctions::print>(args, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Null, result.type);
 }
 
 void test_nativefn_rnd_onearg() {
-  std::vector<std::unique_ptr<Values::RuntimeVal>> args;
-  args.push_back(std::make_unique<Values::NumberVal>(5));
+  Values::Value argBuffer[] = { Values::Value::makeNumber(5) };
+  Values::ArgSpan args = { argBuffer, 1, "random" };
   Environment env;
-  std::unique_ptr<Values::RuntimeVal> result = NativeFunctions::rnd(args, &env);
-  TEST_ASSERT_EQUAL(Values::ValueType::Number, result->type);
-  TEST_ASSERT_GREATER_OR_EQUAL(0, static_cast<Values::NumberVal *>(result.get())->value);
-  TEST_ASSERT_LESS_THAN(5, static_cast<Values::NumberVal *>(result.get())->value);
+  Values::Value result = NativeBinding::bindNative<&NativeFunctions::rnd>(args, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Number, result.type);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, result.number);
+  TEST_ASSERT_LESS_THAN(5, result.number);
 }
 
 void test_nativefn_rnd_twoargs() {
-  std::vector<std::unique_ptr<Values::RuntimeVal>> args;
-  args.push_back(std::make_unique<Values::NumberVal>(5));
-  args.push_back(std::make_unique<Values::NumberVal>(10));
+  Values::Value argBuffer[] = { Values::Value::makeNumber(5), Values::Value::makeNumber(10) };
+  Values::ArgSpan args = { argBuffer, 2, "random" };
   Environment env;
-  std::unique_ptr<Values::RuntimeVal> result = NativeFunctions::rnd(args, &env);
-  TEST_ASSERT_EQUAL(Values::ValueType::Number, result->type);
-  TEST_ASSERT_GREATER_OR_EQUAL(5, static_cast<Values::NumberVal *>(result.get())->value);
-  TEST_ASSERT_LESS_THAN(10, static_cast<Values::NumberVal *>(result.get())->value);
+  Values::Value result = NativeBinding::bindNative<&NativeFunctions::rnd>(args, &env);
+  TEST_ASSERT_EQUAL(Values::ValueType::Number, result.type);
+  TEST_ASSERT_GREATER_OR_EQUAL(5, result.number);
+  TEST_ASSERT_LESS_THAN(10, result.number);
+}
+
+int boundSum(int a, NativeBinding::Optional<int> b) {
+  return b.given ? a + b.value : a;
+}
+
+void test_nativefn_bind_optional_arg() {
+  Values::Value argBuffer[] = { Values::Value::makeNumber(5), Values::Value::makeNumber(10) };
+  Values::ArgSpan args = { argBuffer, 1, "boundSum" };
+  Environment env;
+  Values::Value result = NativeBinding::bindNative<&boundSum>(args, &env);
+  TEST_ASSERT_EQUAL(5, result.number);
+
+  args.size = 2;
+  result = NativeBinding::bindNative<&boundSum>(args, &env);
+  TEST_ASSERT_EQUAL(15, result.number);
 }
 
 // other functions cannot be tested as they rely on connected devices
\ No newline at end of file
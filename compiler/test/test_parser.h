@@ -10,7 +10,7 @@ void test_parser_const_var_decl() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(true, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 
@@ -21,7 +21,7 @@ void test_parser_number_var_decl() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 
@@ -32,7 +32,7 @@ void test_parser_string_var_decl() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL_STRING("hello", static_cast<AstNodes::StringLiteral*>(varDecl->value.get())->value);
 }
 
@@ -43,12 +43,15 @@ void test_parser_object_var_decl() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(AstNodes::NodeType::ObjectLiteral, varDecl->value->kind);
   AstNodes::ObjectLiteral* obj = static_cast<AstNodes::ObjectLiteral*>(varDecl->value.get());
-  TEST_ASSERT_EQUAL(2, obj->properties.size());
-  TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(obj->properties["a"].get())->num);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<AstNodes::StringLiteral*>(obj->properties["b"].get())->value);
+  TEST_ASSERT_EQUAL(2, obj->shape->size());
+  TEST_ASSERT_EQUAL(2, obj->values.size());
+  TEST_ASSERT_EQUAL(0, obj->shape->slotOf("a"));
+  TEST_ASSERT_EQUAL(1, obj->shape->slotOf("b"));
+  TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(obj->values[0].get())->num);
+  TEST_ASSERT_EQUAL_STRING("hello", static_cast<AstNodes::StringLiteral*>(obj->values[1].get())->value);
 }
 
 void test_parser_array_var_decl() {
@@ -58,7 +61,7 @@ void test_parser_array_var_decl() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(AstNodes::NodeType::ArrayLiteral, varDecl->value->kind);
   AstNodes::ArrayLiteral* arr = static_cast<AstNodes::ArrayLiteral*>(varDecl->value.get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::NumericLiteral, arr->elementDataType);
@@ -75,10 +78,10 @@ void test_parser_assignment_expr() {
   TEST_ASSERT_EQUAL(2, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
   AstNodes::AssignmentExpr* assignExpr = static_cast<AstNodes::AssignmentExpr*>(program->body[1].get());
-  TEST_ASSERT_EQUAL_STRING("x", static_cast<AstNodes::Identifier*>(assignExpr->assignee.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(static_cast<AstNodes::Identifier*>(assignExpr->assignee.get())->symbol));
   TEST_ASSERT_EQUAL(10, static_cast<AstNodes::NumericLiteral*>(assignExpr->value.get())->num);
 }
 
@@ -89,11 +92,11 @@ void test_parser_if_stmt() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::IfStmt* ifStmt = static_cast<AstNodes::IfStmt*>(program->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, ifStmt->test->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(ifStmt->test.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(ifStmt->test.get())->symbol));
   TEST_ASSERT_EQUAL(1, ifStmt->consequent->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(ifStmt->consequent->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 
@@ -104,16 +107,16 @@ void test_parser_if_else_stmt() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::IfStmt* ifStmt = static_cast<AstNodes::IfStmt*>(program->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, ifStmt->test->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(ifStmt->test.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(ifStmt->test.get())->symbol));
   TEST_ASSERT_EQUAL(1, ifStmt->consequent->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(ifStmt->consequent->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
   TEST_ASSERT_EQUAL(1, ifStmt->alternate->body.size());
   varDecl = static_cast<AstNodes::VarDeclaration*>(ifStmt->alternate->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("y", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("y", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(10, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 void test_parser_if_stmt_logical_expr() {
@@ -126,20 +129,20 @@ void test_parser_if_stmt_logical_expr() {
 
   AstNodes::LogicalExpr* andLogicalExpr = static_cast<AstNodes::LogicalExpr*>(ifStmt->test.get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, andLogicalExpr->left->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(andLogicalExpr->left.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(andLogicalExpr->left.get())->symbol));
   TEST_ASSERT_EQUAL(AstNodes::NodeType::LogicalExpr, andLogicalExpr->right->kind);
 
   AstNodes::LogicalExpr* orLogicalExpr = static_cast<AstNodes::LogicalExpr*>(andLogicalExpr->right.get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, orLogicalExpr->left->kind);
-  TEST_ASSERT_EQUAL_STRING("false", static_cast<AstNodes::Identifier*>(orLogicalExpr->left.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("false", Symbols::name(static_cast<AstNodes::Identifier*>(orLogicalExpr->left.get())->symbol));
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, orLogicalExpr->right->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(orLogicalExpr->right.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(orLogicalExpr->right.get())->symbol));
 
   TEST_ASSERT_EQUAL(1, ifStmt->consequent->body.size());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::VarDeclaration, ifStmt->consequent->body[0]->kind);
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(ifStmt->consequent->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 
@@ -158,7 +161,7 @@ void test_parser_if_stmt_relational_expr() {
   TEST_ASSERT_EQUAL(1, ifStmt->consequent->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(ifStmt->consequent->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 
@@ -174,6 +177,7 @@ void test_parser_additive_expr() {
   TEST_ASSERT_EQUAL(AstNodes::NodeType::NumericLiteral, binaryExpr->right->kind);
   TEST_ASSERT_EQUAL(10, static_cast<AstNodes::NumericLiteral*>(binaryExpr->right.get())->num);
   TEST_ASSERT_EQUAL_STRING("+", binaryExpr->op);
+  TEST_ASSERT_TRUE(binaryExpr->opcode == AstNodes::BinaryOp::Add);
 }
 
 void test_parser_multiplicative_expr() {
@@ -214,11 +218,11 @@ void test_parser_while_stmt() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::WhileStmt* whileStmt = static_cast<AstNodes::WhileStmt*>(program->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, whileStmt->test->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(whileStmt->test.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(whileStmt->test.get())->symbol));
   TEST_ASSERT_EQUAL(1, whileStmt->body->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(whileStmt->body->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   TEST_ASSERT_EQUAL(5, static_cast<AstNodes::NumericLiteral*>(varDecl->value.get())->num);
 }
 void test_parser_break_stmt() {
@@ -228,7 +232,7 @@ void test_parser_break_stmt() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::WhileStmt* whileStmt = static_cast<AstNodes::WhileStmt*>(program->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, whileStmt->test->kind);
-  TEST_ASSERT_EQUAL_STRING("true", static_cast<AstNodes::Identifier*>(whileStmt->test.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("true", Symbols::name(static_cast<AstNodes::Identifier*>(whileStmt->test.get())->symbol));
   TEST_ASSERT_EQUAL(1, whileStmt->body->body.size());
   AstNodes::BreakStmt* breakStmt = static_cast<AstNodes::BreakStmt*>(whileStmt->body->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::BreakStmt, breakStmt->kind);
@@ -241,7 +245,7 @@ void test_parser_call_expr() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::CallExpr* callExpr = static_cast<AstNodes::CallExpr*>(program->body[0].get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, callExpr->caller->kind);
-  TEST_ASSERT_EQUAL_STRING("foo", static_cast<AstNodes::Identifier*>(callExpr->caller.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("foo", Symbols::name(static_cast<AstNodes::Identifier*>(callExpr->caller.get())->symbol));
   TEST_ASSERT_EQUAL(0, callExpr->args.size());
 }
 
@@ -252,10 +256,10 @@ void test_parser_call_expr_args() {
     TEST_ASSERT_EQUAL(1, program->body.size());
     AstNodes::CallExpr* callExpr = static_cast<AstNodes::CallExpr*>(program->body[0].get());
     TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, callExpr->caller->kind);
-    TEST_ASSERT_EQUAL_STRING("foo", static_cast<AstNodes::Identifier*>(callExpr->caller.get())->symbol);
+    TEST_ASSERT_EQUAL_STRING("foo", Symbols::name(static_cast<AstNodes::Identifier*>(callExpr->caller.get())->symbol));
     TEST_ASSERT_EQUAL(3, callExpr->args.size());
     TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, callExpr->args[0]->kind);
-    TEST_ASSERT_EQUAL_STRING("bar", static_cast<AstNodes::Identifier*>(callExpr->args[0].get())->symbol);
+    TEST_ASSERT_EQUAL_STRING("bar", Symbols::name(static_cast<AstNodes::Identifier*>(callExpr->args[0].get())->symbol));
     TEST_ASSERT_EQUAL(AstNodes::NodeType::StringLiteral, callExpr->args[1]->kind);
     TEST_ASSERT_EQUAL_STRING("baz", static_cast<AstNodes::StringLiteral*>(callExpr->args[1].get())->value);
     TEST_ASSERT_EQUAL(AstNodes::NodeType::NumericLiteral, callExpr->args[2]->kind);
@@ -269,12 +273,12 @@ void test_parser_member_expr() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   AstNodes::MemberExpr* memberExpr = static_cast<AstNodes::MemberExpr*>(varDecl->value.get());
   TEST_ASSERT_EQUAL_MESSAGE(AstNodes::NodeType::Identifier, memberExpr->object->kind, "foo was not an identifier");
-  TEST_ASSERT_EQUAL_STRING("foo", static_cast<AstNodes::Identifier*>(memberExpr->object.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("foo", Symbols::name(static_cast<AstNodes::Identifier*>(memberExpr->object.get())->symbol));
   TEST_ASSERT_EQUAL_MESSAGE(AstNodes::NodeType::Identifier, memberExpr->property->kind, "bar was not an identifier");
-  TEST_ASSERT_EQUAL_STRING("bar", static_cast<AstNodes::Identifier*>(memberExpr->property.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("bar", Symbols::name(static_cast<AstNodes::Identifier*>(memberExpr->property.get())->symbol));
   TEST_ASSERT_EQUAL(false, memberExpr->computed);
 }
 
@@ -285,11 +289,43 @@ void test_parser_member_expr_computed() {
   TEST_ASSERT_EQUAL(1, program->body.size());
   AstNodes::VarDeclaration* varDecl = static_cast<AstNodes::VarDeclaration*>(program->body[0].get());
   TEST_ASSERT_EQUAL(false, varDecl->constant);
-  TEST_ASSERT_EQUAL_STRING("x", varDecl->ident);
+  TEST_ASSERT_EQUAL_STRING("x", Symbols::name(varDecl->ident));
   AstNodes::MemberExpr* memberExpr = static_cast<AstNodes::MemberExpr*>(varDecl->value.get());
   TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, memberExpr->object->kind);
-  TEST_ASSERT_EQUAL_STRING("foo", static_cast<AstNodes::Identifier*>(memberExpr->object.get())->symbol);
+  TEST_ASSERT_EQUAL_STRING("foo", Symbols::name(static_cast<AstNodes::Identifier*>(memberExpr->object.get())->symbol));
   TEST_ASSERT_EQUAL(AstNodes::NodeType::StringLiteral, memberExpr->property->kind);
   TEST_ASSERT_EQUAL_STRING("bar", static_cast<AstNodes::StringLiteral*>(memberExpr->property.get())->value);
   TEST_ASSERT_EQUAL(true, memberExpr->computed);
-}
\ No newline at end of file
+}
+void test_parser_function_declaration() {
+  char code[] = "fn add(a, b) { let s = a + b; return s; }";
+  Parser parser = Parser();
+  AstNodes::Program* program = parser.produceAST(code, sizeof(code) - 1);
+  TEST_ASSERT_EQUAL(1, program->body.size());
+  TEST_ASSERT_EQUAL(AstNodes::NodeType::FunctionDeclaration, program->body[0]->kind);
+  AstNodes::FunctionDeclaration* function = static_cast<AstNodes::FunctionDeclaration*>(program->body[0].get());
+  TEST_ASSERT_EQUAL_STRING("add", Symbols::name(function->name));
+  TEST_ASSERT_EQUAL(2, function->params.size());
+  TEST_ASSERT_EQUAL_STRING("a", Symbols::name(function->params[0]));
+  TEST_ASSERT_EQUAL_STRING("b", Symbols::name(function->params[1]));
+  // the body declares its variables in the call frame
+  TEST_ASSERT_FALSE(function->body->declaresVariables);
+  TEST_ASSERT_EQUAL(2, function->body->body.size());
+  TEST_ASSERT_EQUAL(AstNodes::NodeType::ReturnStmt, function->body->body[1]->kind);
+  TEST_ASSERT_EQUAL(AstNodes::NodeType::Identifier, static_cast<AstNodes::ReturnStmt*>(function->body->body[1].get())->value->kind);
+}
+void test_parser_constant_pool() {
+  char code[] = "let a = \"hi\"; let b = \"ho\"; let c = \"hi\";";
+  Parser parser = Parser();
+  AstNodes::Program* program = parser.produceAST(code, sizeof(code) - 1);
+  TEST_ASSERT_EQUAL(2, program->constants.size());
+  AstNodes::StringLiteral* a = static_cast<AstNodes::StringLiteral*>(static_cast<AstNodes::VarDeclaration*>(program->body[0].get())->value.get());
+  AstNodes::StringLiteral* b = static_cast<AstNodes::StringLiteral*>(static_cast<AstNodes::VarDeclaration*>(program->body[1].get())->value.get());
+  AstNodes::StringLiteral* c = static_cast<AstNodes::StringLiteral*>(static_cast<AstNodes::VarDeclaration*>(program->body[2].get())->value.get());
+  TEST_ASSERT_EQUAL(0, a->constant);
+  TEST_ASSERT_EQUAL(1, b->constant);
+  // equal literals share one entry
+  TEST_ASSERT_EQUAL(0, c->constant);
+  TEST_ASSERT_TRUE(a->value == c->value);
+  TEST_ASSERT_EQUAL_STRING("ho", program->constants.at(b->constant));
+}
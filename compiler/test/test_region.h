@@ -0,0 +1,73 @@
+#pragma once
+
+#include <unity.h>
+#include "interpreter/Region.h"
+#include "interpreter/Values.h"
+#include "interpreter/Environment.h"
+
+void test_region_recycles_blocks() {
+  Region::Scope region(1024);
+  TEST_ASSERT_TRUE(Region::isOpen());
+
+  void* first = Region::allocate(Region::granularity + 4);
+  TEST_ASSERT_TRUE(Region::contains(first));
+  Region::deallocate(first, Region::granularity + 4);
+
+  // same size class
+  void* second = Region::allocate(2 * Region::granularity);
+  TEST_ASSERT_TRUE(first == second);
+  Region::deallocate(second, 2 * Region::granularity);
+
+  void* large = Region::allocate(regionSizeClasses * Region::granularity + 1);
+  TEST_ASSERT_FALSE(Region::contains(large));
+  Region::deallocate(large, regionSizeClasses * Region::granularity + 1);
+}
+
+void test_region_heap_fallback() {
+  TEST_ASSERT_FALSE(Region::isOpen());
+  void* ptr = Region::allocate(16);
+  TEST_ASSERT_FALSE(Region::contains(ptr));
+  Region::deallocate(ptr, 16);
+
+  Region::Scope region(2 * Region::granularity);
+  void* a = Region::allocate(Region::granularity);
+  void* b = Region::allocate(Region::granularity);
+  void* full = Region::allocate(Region::granularity);
+  TEST_ASSERT_TRUE(Region::contains(a));
+  TEST_ASSERT_TRUE(Region::contains(b));
+  TEST_ASSERT_FALSE(Region::contains(full));
+  Region::deallocate(a, Region::granularity);
+  Region::deallocate(b, Region::granularity);
+  Region::deallocate(full, Region::granularity);
+}
+
+void test_region_values() {
+  {
+    Region::Scope region;
+    Environment env;
+    Values::Value arr = Values::Value::makeArray();
+    arr.array->push(Values::Value::makeString("hello from the region"));
+    TEST_ASSERT_TRUE(Region::contains(arr.array));
+    TEST_ASSERT_TRUE(Region::contains(arr.array->get(0).string->str));
+
+    env.declareVar("arr", std::move(arr), false);
+    TEST_ASSERT_TRUE(Region::contains(env.lookupVar("arr").array));
+    TEST_ASSERT_GREATER_THAN(0, Region::usedBytes());
+  }
+  TEST_ASSERT_FALSE(Region::isOpen());
+}
+
+void test_region_buffers() {
+  Region::Scope region(1024);
+  size_t size = regionSizeClasses * Region::granularity + 1;
+  void* buffer = Region::allocateBuffer(size);
+  TEST_ASSERT_TRUE(Region::contains(buffer));
+
+  // freeing the last buffer returns its space
+  size_t used = Region::usedBytes();
+  void* last = Region::allocateBuffer(size);
+  TEST_ASSERT_TRUE(Region::contains(last));
+  Region::deallocateBuffer(last, size);
+  TEST_ASSERT_EQUAL(used, Region::usedBytes());
+  Region::deallocateBuffer(buffer, size);
+}
@@ -1,111 +1,241 @@
 #pragma once
 
 #include <unity.h>
-#include <memory>
 #include <map>
 #include <vector>
 #include "interpreter/Values.h"
 
 void test_values_null_constructor() {
-  Values::NullVal nullVal;
+  Values::Value nullVal;
   TEST_ASSERT_EQUAL(Values::ValueType::Null, nullVal.type);
+  TEST_ASSERT_FALSE(nullVal.isHeap());
 }
 
-void test_values_boolean_default_constructor() {
-  Values::BooleanVal boolVal;
+void test_values_boolean_constructor() {
+  Values::Value boolVal = Values::Value::makeBoolean(false);
   TEST_ASSERT_EQUAL(Values::ValueType::Boolean, boolVal.type);
-  TEST_ASSERT_TRUE(boolVal.value);
+  TEST_ASSERT_FALSE(boolVal.boolean);
+  TEST_ASSERT_FALSE(boolVal.isHeap());
 }
 
-void test_values_boolean_parameterized_constructor() {
-  Values::BooleanVal boolVal(false);
-  TEST_ASSERT_EQUAL(Values::ValueType::Boolean, boolVal.type);
-  TEST_ASSERT_FALSE(boolVal.value);
-}
-
-void test_values_number_default_constructor() {
-  Values::NumberVal numVal;
+void test_values_number_constructor() {
+  Values::Value numVal = Values::Value::makeNumber(42);
   TEST_ASSERT_EQUAL(Values::ValueType::Number, numVal.type);
-  TEST_ASSERT_EQUAL(0, numVal.value);
+  TEST_ASSERT_EQUAL(42, numVal.number);
+  TEST_ASSERT_FALSE(numVal.isHeap());
 }
 
-void test_values_number_parameterized_constructor() {
-  Values::NumberVal numVal(42);
-  TEST_ASSERT_EQUAL(Values::ValueType::Number, numVal.type);
-  TEST_ASSERT_EQUAL(42, numVal.value);
+void test_values_value_size() {
+  // a tag plus one machine word, 8 bytes on the ESP8266
+  TEST_ASSERT_LESS_OR_EQUAL(2 * sizeof(void *), sizeof(Values::Value));
 }
 
 void test_values_string_default_constructor() {
   Values::StringVal strVal;
-  TEST_ASSERT_EQUAL(Values::ValueType::String, strVal.type);
   TEST_ASSERT_NULL(strVal.str);
 }
 
 void test_values_string_parameterized_constructor() {
-  Values::StringVal strVal("Hello");
+  Values::Value strVal = Values::Value::makeString("Hello from the pads");
   TEST_ASSERT_EQUAL(Values::ValueType::String, strVal.type);
-  TEST_ASSERT_NOT_NULL(strVal.str);
-  TEST_ASSERT_EQUAL_STRING("Hello", strVal.str);
+  TEST_ASSERT_TRUE(strVal.isHeap());
+  TEST_ASSERT_NOT_NULL(strVal.string->str);
+  TEST_ASSERT_EQUAL_STRING("Hello from the pads", strVal.string->str);
 }
 
 void test_values_string_copy_constructor() {
-  Values::StringVal strVal1("Hello");
-  Values::StringVal strVal2(strVal1);
+  Values::Value strVal1 = Values::Value::makeString("Hello from the pads");
+  Values::Value strVal2(strVal1);
   TEST_ASSERT_EQUAL(Values::ValueType::String, strVal2.type);
-  TEST_ASSERT_NOT_NULL(strVal2.str);
-  TEST_ASSERT_EQUAL_STRING("Hello", strVal2.str);
+  TEST_ASSERT_EQUAL_STRING("Hello from the pads", strVal2.cstr());
+  TEST_ASSERT_TRUE(strVal1.string == strVal2.string);
+  TEST_ASSERT_EQUAL(2, strVal1.string->refCount);
 }
 
 void test_values_string_move_constructor() {
-  Values::StringVal strVal1("Hello");
-  Values::StringVal strVal2(std::move(strVal1));
+  Values::Value strVal1 = Values::Value::makeString("Hello from the pads");
+  Values::Value strVal2(std::move(strVal1));
   TEST_ASSERT_EQUAL(Values::ValueType::String, strVal2.type);
-  TEST_ASSERT_NOT_NULL(strVal2.str);
-  TEST_ASSERT_EQUAL_STRING("Hello", strVal2.str);
-  TEST_ASSERT_NULL(strVal1.str);
+  TEST_ASSERT_EQUAL_STRING("Hello from the pads", strVal2.cstr());
+  TEST_ASSERT_EQUAL(Values::ValueType::Null, strVal1.type);
+}
+
+void test_values_string_inline() {
+  Values::Value strVal1 = Values::Value::makeString("Hello");
+  TEST_ASSERT_FALSE(strVal1.isHeap());
+  Values::Value strVal2 = strVal1;
+  strVal1 = Values::Value::makeNull();
+  TEST_ASSERT_EQUAL_STRING("Hello", strVal2.cstr());
+  TEST_ASSERT_EQUAL(5, strVal2.length());
+}
+
+void test_values_string_immortal() {
+  static const char literal[] = "Hello from the pads";
+  Values::Value strVal1 = Values::Value::makeImmortalString(literal);
+  TEST_ASSERT_EQUAL(Values::ValueType::String, strVal1.type);
+  TEST_ASSERT_FALSE(strVal1.isHeap());
+  // copies share the characters without copying them
+  Values::Value strVal2 = strVal1;
+  TEST_ASSERT_TRUE(strVal2.cstr() == literal);
+  TEST_ASSERT_EQUAL(19, strVal2.length());
+  Values::Value joined = Values::Value::concat(strVal1, strVal2);
+  strVal1 = Values::Value::makeNull();
+  TEST_ASSERT_EQUAL_STRING("Hello from the padsHello from the pads", joined.cstr());
+  // short strings are still inlined
+  Values::Value strVal3 = Values::Value::makeImmortalString("Hi");
+  TEST_ASSERT_EQUAL_STRING("Hi", strVal3.cstr());
+}
+
+void test_values_string_rope() {
+  Values::Value str = Values::Value::makeString("Round ");
+  for (int i = 0; i < 100; i++) {
+    str = Values::Value::concat(str, Values::Value::makeString("x"));
+  }
+  TEST_ASSERT_TRUE(str.isHeap());
+  TEST_ASSERT_NULL(str.string->str);
+  TEST_ASSERT_EQUAL(106, str.length());
+
+  const char* flat = str.cstr();
+  TEST_ASSERT_EQUAL(106, strlen(flat));
+  TEST_ASSERT_EQUAL(0, strncmp("Round xxx", flat, 9));
+  TEST_ASSERT_EQUAL('x', flat[105]);
+}
+
+Shape *makeTestShape() {
+  Shape *shape = new Shape();
+  shape->addKey("num");
+  shape->addKey("str");
+  return shape;
 }
 
 void test_values_object_default_constructor() {
-  Values::ObjectVal objVal;
+  Shape *shape = makeTestShape();
+  Values::Value objVal = Values::Value::makeObject(shape);
+  shape->release();
   TEST_ASSERT_EQUAL(Values::ValueType::ObjectVal, objVal.type);
-  TEST_ASSERT_TRUE(objVal.properties.empty());
+  TEST_ASSERT_EQUAL(2, objVal.object->slots.size());
+  TEST_ASSERT_EQUAL(Values::ValueType::Null, objVal.object->slots[0].type);
 }
 
 void test_values_object_insertion() {
-  Values::ObjectVal obj;
-  obj.properties["num"] = std::make_unique<Values::NumberVal>(5);
-  obj.properties["str"] = std::make_unique<Values::StringVal>("hello");
+  Shape *shape = makeTestShape();
+  Values::Value obj = Values::Value::makeObject(shape);
+  shape->release();
+  obj.mutableObject()->slots[shape->slotOf("num")] = Values::Value::makeNumber(5);
+  obj.mutableObject()->slots[shape->slotOf("str")] = Values::Value::makeString("hello");
+
+  TEST_ASSERT_EQUAL(Values::ValueType::Number, obj.object->property("num")->type);
+  TEST_ASSERT_EQUAL(Values::ValueType::String, obj.object->property("str")->type);
+  TEST_ASSERT_NULL(obj.object->property("missing"));
+
+  TEST_ASSERT_EQUAL(5, obj.object->property("num")->number);
+  TEST_ASSERT_EQUAL_STRING("hello", obj.object->property("str")->cstr());
+}
+
+void test_values_object_move_constructor() {
+  Shape *shape = makeTestShape();
+  Values::Value obj = Values::Value::makeObject(shape);
+  shape->release();
+  obj.mutableObject()->slots[0] = Values::Value::makeNumber(5);
+  obj.mutableObject()->slots[1] = Values::Value::makeString("hello");
+
+  Values::Value obj2(std::move(obj));
+  TEST_ASSERT_EQUAL(5, obj2.object->property("num")->number);
+  TEST_ASSERT_EQUAL_STRING("hello", obj2.object->property("str")->cstr());
+  TEST_ASSERT_EQUAL(Values::ValueType::Null, obj.type);
+}
+
+void test_values_object_clone() {
+  Shape *shape = makeTestShape();
+  Values::Value obj = Values::Value::makeObject(shape);
+  shape->release();
+  obj.mutableObject()->slots[0] = Values::Value::makeNumber(5);
+  obj.mutableObject()->slots[1] = Values::Value::makeString("hello");
+
+  Values::Value clonedObj = obj;
+  clonedObj.mutableObject()->slots[0] = Values::Value::makeNumber(6);
+
+  TEST_ASSERT_TRUE(clonedObj.object->shape == obj.object->shape);
+  TEST_ASSERT_EQUAL(5, obj.object->property("num")->number);
+  TEST_ASSERT_EQUAL(6, clonedObj.object->property("num")->number);
+  TEST_ASSERT_EQUAL_STRING("hello", clonedObj.object->property("str")->cstr());
+}
 
-  TEST_ASSERT_EQUAL(Values::ValueType::Number, obj.properties["num"]->type);
-  TEST_ASSERT_EQUAL(Values::ValueType::String, obj.properties["str"]->type);
+void test_values_array_shared_copy() {
+  Values::Value arr = Values::Value::makeArray();
+  arr.mutableArray()->push(Values::Value::makeNumber(1));
 
-  TEST_ASSERT_EQUAL(2, obj.properties.size());
-  TEST_ASSERT_EQUAL(5, static_cast<Values::NumberVal *>(obj.properties["num"].get())->value);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<Values::StringVal *>(obj.properties["str"].get())->str);
+  Values::Value copy = arr;
+  TEST_ASSERT_TRUE(copy.array == arr.array);
+  TEST_ASSERT_EQUAL(2, arr.array->refCount);
 }
 
-void test_values_object_move_constructor() {
-  Values::ObjectVal obj;
-  obj.properties["num"] = std::make_unique<Values::NumberVal>(5);
-  obj.properties["str"] = std::make_unique<Values::StringVal>("hello");
-  TEST_ASSERT_EQUAL(5, static_cast<Values::NumberVal *>(obj.properties.at("num").get())->value);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<Values::StringVal *>(obj.properties.at("str").get())->str);
-  TEST_ASSERT_EQUAL(2, obj.properties.size());
+void test_values_array_copy_on_write() {
+  Values::Value arr = Values::Value::makeArray();
+  arr.mutableArray()->push(Values::Value::makeNumber(1));
 
-  Values::ObjectVal obj2(std::move(obj));
-  TEST_ASSERT_EQUAL(5, static_cast<Values::NumberVal *>(obj2.properties["num"].get())->value);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<Values::StringVal *>(obj2.properties["str"].get())->str);
-  TEST_ASSERT_EQUAL(2, obj2.properties.size());
+  Values::Value copy = arr;
+  copy.mutableArray()->set(0, Values::Value::makeNumber(2));
+
+  TEST_ASSERT_TRUE(copy.array != arr.array);
+  TEST_ASSERT_EQUAL(1, arr.array->refCount);
+  TEST_ASSERT_EQUAL(1, copy.array->refCount);
+  TEST_ASSERT_EQUAL(1, arr.array->get(0).number);
+  TEST_ASSERT_EQUAL(2, copy.array->get(0).number);
 }
 
-void test_values_object_clone() {
-  Values::ObjectVal obj;
-  obj.properties["num"] = std::make_unique<Values::NumberVal>(5);
-  obj.properties["str"] = std::make_unique<Values::StringVal>("hello");
-
-  std::unique_ptr<Values::RuntimeVal> clonedObj = obj.clone();
-  Values::ObjectVal* clonedObjPtr = static_cast<Values::ObjectVal* >(clonedObj.get());
-  TEST_ASSERT_EQUAL(5, static_cast<Values::NumberVal *>(clonedObjPtr->properties["num"].get())->value);
-  TEST_ASSERT_EQUAL_STRING("hello", static_cast<Values::StringVal *>(clonedObjPtr->properties["str"].get())->str);
-  TEST_ASSERT_EQUAL(2, clonedObjPtr->properties.size());
-}
\ No newline at end of file
+void test_values_array_packing() {
+  Values::Value arr = Values::Value::makeArray();
+  arr.mutableArray()->push(Values::Value::makeBoolean(true));
+  arr.mutableArray()->push(Values::Value::makeBoolean(false));
+  arr.mutableArray()->pack();
+  TEST_ASSERT_EQUAL(Values::ElementKind::Bits, arr.array->kind);
+  TEST_ASSERT_TRUE(arr.array->get(0).boolean);
+  TEST_ASSERT_FALSE(arr.array->get(1).boolean);
+
+  arr.mutableArray()->set(1, Values::Value::makeNumber(7));
+  TEST_ASSERT_EQUAL(Values::ElementKind::Generic, arr.array->kind);
+  TEST_ASSERT_TRUE(arr.array->get(0).boolean);
+  TEST_ASSERT_EQUAL(7, arr.array->get(1).number);
+}
+
+void test_values_native_closure() {
+  int calls = 0;
+  Values::Value fn = Values::Value::makeNativeClosure([&calls](const Values::ArgSpan& args, Environment*) {
+    calls++;
+    return Values::Value::makeNumber(args[0].number * 2);
+  });
+  TEST_ASSERT_TRUE(fn.isClosure());
+
+  Values::Value copy = fn;
+  TEST_ASSERT_EQUAL(2, fn.closure->refCount);
+
+  Values::Value argBuffer[] = { Values::Value::makeNumber(21) };
+  Values::ArgSpan args = { argBuffer, 1, "double" };
+  TEST_ASSERT_EQUAL(42, copy.call(args, nullptr).number);
+  TEST_ASSERT_EQUAL(1, calls);
+}
+
+void test_values_fixed_conversion() {
+  char buf[13];
+  Fixed::toString(Fixed::parse("-3.1416"), buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("-3.1416", buf);
+  Fixed::toString(Fixed::fromInt(2), buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("2.0", buf);
+  TEST_ASSERT_EQUAL(-1, Fixed::toInt(Fixed::parse("-1.75")));
+  TEST_ASSERT_EQUAL(Fixed::one / 2, Values::Value::makeFixed(Fixed::one / 2).asFixed());
+  TEST_ASSERT_EQUAL(Fixed::fromInt(3), Values::Value::makeNumber(3).asFixed());
+}
+
+void test_values_fixed_range() {
+  // integers outside of the Q16.16 range are rejected instead of wrapping around
+  TEST_ASSERT_TRUE(Fixed::fitsInt(32767));
+  TEST_ASSERT_TRUE(Fixed::fitsInt(-32768));
+  TEST_ASSERT_FALSE(Fixed::fitsInt(40000));
+  TEST_ASSERT_FALSE(Fixed::fitsInt(-32769));
+  TEST_ASSERT_FALSE(Fixed::fits((int64_t)Fixed::fromInt(32767) + Fixed::one));
+  TEST_ASSERT_FALSE(Fixed::fits(((int64_t)Fixed::fromInt(300) * Fixed::fromInt(300)) >> Fixed::fractionBits));
+  TEST_ASSERT_EQUAL(Fixed::parse("32767.5"), Fixed::add(Fixed::fromInt(32767), Fixed::one / 2));
+  TEST_ASSERT_EQUAL(Fixed::fromInt(-32768), Fixed::parse("-32768"));
+  TEST_ASSERT_EQUAL(Fixed::fromInt(-32768), Fixed::sub(Fixed::fromInt(-32767), Fixed::one));
+}